@@ -0,0 +1,84 @@
+#ifndef LWCRON_BENCH_H_INCLUDED
+#define LWCRON_BENCH_H_INCLUDED
+
+#include <cinttypes>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace lwcron {
+
+namespace bench {
+
+// Time stamp counter, which on x86 ticks at a fixed reference rate
+// rather than the core clock, so it's close to cycles with frequency
+// scaling off. Zero elsewhere.
+inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+class State {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t iterations_;
+    uint32_t arg_;
+    Clock::time_point started_;
+    uint64_t started_cycles_;
+
+public:
+    State(uint64_t iterations, uint32_t arg) : iterations_(iterations), arg_(arg), started_(Clock::now()), started_cycles_(cycles()) {
+    }
+
+public:
+    uint64_t iterations() const {
+        return iterations_;
+    }
+
+    uint32_t arg() const {
+        return arg_;
+    }
+
+    // Call after any setup that shouldn't be measured.
+    void reset_timer() {
+        started_ = Clock::now();
+        started_cycles_ = cycles();
+    }
+
+    uint64_t elapsed_ns() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started_).count();
+    }
+
+    uint64_t elapsed_cycles() const {
+        return cycles() - started_cycles_;
+    }
+};
+
+struct Benchmark {
+    const char *name;
+    void (*fn)(State &state);
+    uint32_t arg;
+    Benchmark *next;
+
+    Benchmark(const char *name, void (*fn)(State &state), uint32_t arg = 0);
+
+    static Benchmark *&head();
+};
+
+// Keeps the compiler from optimizing away a value that's never used.
+template<typename T>
+inline void keep(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}
+
+}
+
+#endif
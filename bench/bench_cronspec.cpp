@@ -0,0 +1,101 @@
+#include <lwcron/lwcron.h>
+#include <lwcron/compiled.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+static constexpr CronSpec Dense = CronSpec::everyFiveMinutes();
+static constexpr CronSpec Sparse = CronSpec::specific(0, 15, 6);
+
+// Start from a different second every time so both the quick and slow
+// cases get hit.
+template<uint32_t (CronSpec::*Next)(DateTime) const>
+static void cronspec_next(State &state, CronSpec const &spec) {
+    auto sum = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        sum += (spec.*Next)(JacobsBirth + (i * 7919) % 86400);
+    }
+    keep(sum);
+}
+
+static void cronspec_next_dense(State &state) {
+    cronspec_next<&CronSpec::getNextTime>(state, Dense);
+}
+
+static void cronspec_next_sparse(State &state) {
+    cronspec_next<&CronSpec::getNextTime>(state, Sparse);
+}
+
+static void cronspec_next_reference_dense(State &state) {
+    cronspec_next<&CronSpec::getNextTimeReference>(state, Dense);
+}
+
+static void cronspec_next_reference_sparse(State &state) {
+    cronspec_next<&CronSpec::getNextTimeReference>(state, Sparse);
+}
+
+static void cronspec_next_compiled(State &state, CronSpec const &spec) {
+    CompiledCronSpec compiled{ spec };
+    state.reset_timer();
+
+    auto sum = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        sum += compiled.getNextTime(JacobsBirth + (i * 7919) % 86400);
+    }
+    keep(sum);
+}
+
+static void cronspec_next_compiled_dense(State &state) {
+    cronspec_next_compiled(state, Dense);
+}
+
+static void cronspec_next_compiled_sparse(State &state) {
+    cronspec_next_compiled(state, Sparse);
+}
+
+static void cronspec_interval(State &state) {
+    auto sum = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        auto spec = CronSpec::interval(1 + (i * 7919) % 7200);
+        sum += spec.hours;
+    }
+    keep(sum);
+}
+
+// Steps a task from one firing to the next, as the scheduler does after
+// running it.
+static void crontask_reschedule(State &state, bool incremental) {
+    CronTask task{ CronSpec::interval(5) };
+    auto time = task.getNextTime(JacobsBirth, 0);
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        if (incremental) {
+            time = task.getNextTimeFrom(time, time + 1, 0);
+        }
+        else {
+            time = task.getNextTime(time + 1, 0);
+        }
+    }
+    keep(time);
+}
+
+static void crontask_reschedule_full(State &state) {
+    crontask_reschedule(state, false);
+}
+
+static void crontask_reschedule_incremental(State &state) {
+    crontask_reschedule(state, true);
+}
+
+static Benchmark cronspec_next_dense_registration{ "cronspec/next/dense", cronspec_next_dense };
+static Benchmark cronspec_next_sparse_registration{ "cronspec/next/sparse", cronspec_next_sparse };
+static Benchmark cronspec_next_reference_dense_registration{ "cronspec/next_reference/dense", cronspec_next_reference_dense };
+static Benchmark cronspec_next_reference_sparse_registration{ "cronspec/next_reference/sparse", cronspec_next_reference_sparse };
+static Benchmark cronspec_next_compiled_dense_registration{ "cronspec/next_compiled/dense", cronspec_next_compiled_dense };
+static Benchmark cronspec_next_compiled_sparse_registration{ "cronspec/next_compiled/sparse", cronspec_next_compiled_sparse };
+static Benchmark cronspec_interval_registration{ "cronspec/interval", cronspec_interval };
+static Benchmark crontask_reschedule_full_registration{ "crontask/reschedule/full", crontask_reschedule_full };
+static Benchmark crontask_reschedule_incremental_registration{ "crontask/reschedule/incremental", crontask_reschedule_incremental };
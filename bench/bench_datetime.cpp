@@ -0,0 +1,39 @@
+#include <lwcron/lwcron.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+static void datetime_from_unix(State &state) {
+    auto t = JacobsBirth.unix_time();
+    auto sum = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        DateTime dt{ t + i * 86399 };
+        sum += dt.year() + dt.month() + dt.day() + dt.hour() + dt.minute() + dt.second();
+    }
+    keep(sum);
+}
+
+static void datetime_to_unix(State &state) {
+    auto sum = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        DateTime dt(1970 + i % 130, 1 + i % 12, 1 + i % 28, i % 24, i % 60, i % 60);
+        sum += dt.unix_time();
+    }
+    keep(sum);
+}
+
+static void datetime_add(State &state) {
+    auto dt = JacobsBirth;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        dt = dt + 1;
+        keep(dt);
+    }
+}
+
+static Benchmark datetime_from_unix_registration{ "datetime/from_unix", datetime_from_unix };
+static Benchmark datetime_to_unix_registration{ "datetime/to_unix", datetime_to_unix };
+static Benchmark datetime_add_registration{ "datetime/add", datetime_add };
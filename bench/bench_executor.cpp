@@ -0,0 +1,68 @@
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/executor.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+constexpr uint32_t ExecutorTasks = 256;
+
+// Burns a few microseconds of CPU each run, every second.
+class BusyTask : public PeriodicTask {
+private:
+    uint32_t value_{ 1 };
+
+public:
+    BusyTask() : PeriodicTask(1) {
+    }
+
+public:
+    void run() override {
+        auto value = value_;
+        for (auto i = 0u; i < 5000; ++i) {
+            value = value * 1664525u + 1013904223u;
+        }
+        value_ = value;
+        keep(value_);
+    }
+};
+
+// One iteration is one tick where every task is due, until they've all
+// finished. Zero workers runs them inline, for comparison.
+static void executor_tick(State &state) {
+    std::vector<BusyTask> tasks(ExecutorTasks);
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    Scheduler scheduler{ all.data(), all.size() };
+    Executor executor{ scheduler, state.arg() };
+    executor.start();
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        if (state.arg() == 0) {
+            while (scheduler.check(now)) {
+            }
+        }
+        else {
+            executor.check(now);
+            executor.wait();
+        }
+        now += 1;
+    }
+}
+
+static Benchmark executor_tick_inline{ "executor/tick/256/inline", executor_tick, 0 };
+static Benchmark executor_tick_1{ "executor/tick/256/1", executor_tick, 1 };
+static Benchmark executor_tick_2{ "executor/tick/256/2", executor_tick, 2 };
+static Benchmark executor_tick_4{ "executor/tick/256/4", executor_tick, 4 };
+static Benchmark executor_tick_8{ "executor/tick/256/8", executor_tick, 8 };
@@ -0,0 +1,31 @@
+#include <lwcron/lwcron.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static const char *Expressions[] = {
+    "0 */5 *",
+    "0 0,20,40 *",
+    "0 15 6",
+    "*/5 0-30 9-17",
+    "10/20 1-10/3,59 23",
+    "0 0 */6",
+    "1,2,3,4,5,6,7,8,9,10 */7 0-11,13-23",
+    "30 * *",
+};
+
+constexpr size_t NumberOfExpressions = sizeof(Expressions) / sizeof(Expressions[0]);
+
+static void expression_parse(State &state) {
+    CronSpec spec;
+    auto parsed = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        parsed += CronSpec::parse(Expressions[i % NumberOfExpressions], spec);
+        keep(spec);
+    }
+    keep(parsed);
+}
+
+static Benchmark expression_parse_registration{ "expression/parse", expression_parse };
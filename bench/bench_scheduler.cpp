@@ -0,0 +1,264 @@
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/compiled.h>
+#include <lwcron/dense.h>
+#include <lwcron/wheel.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+// Short intervals between 10s and 5 minutes, so a few percent of the
+// tasks are due every second.
+static std::vector<PeriodicTask> periodic_tasks(uint32_t size) {
+    std::vector<PeriodicTask> tasks;
+    tasks.reserve(size);
+    for (auto i = 0u; i < size; ++i) {
+        tasks.emplace_back(10 + (i * 7919) % 300);
+    }
+    return tasks;
+}
+
+static std::vector<Task*> pointers(std::vector<PeriodicTask> &tasks) {
+    std::vector<Task*> pointers;
+    for (auto &task : tasks) {
+        pointers.push_back(&task);
+    }
+    return pointers;
+}
+
+// One iteration is one second of wall time, checking until nothing's due.
+static void tick(State &state, Scheduler &scheduler) {
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    auto fired = 0u;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        while (scheduler.check(now)) {
+            fired++;
+        }
+        now += 1;
+    }
+    keep(fired);
+}
+
+static void scheduler_tick_scan(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    Scheduler scheduler{ all.data(), all.size() };
+    tick(state, scheduler);
+}
+
+static void scheduler_tick_heap(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    std::vector<HeapQueue::Slot> slots(all.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    Scheduler scheduler{ all.data(), all.size(), queue };
+    tick(state, scheduler);
+}
+
+static void scheduler_tick_wheel(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    std::vector<TimingWheel::Slot> slots(all.size());
+    TimingWheel queue{ slots.data(), slots.size() };
+    Scheduler scheduler{ all.data(), all.size(), queue };
+    tick(state, scheduler);
+}
+
+static void scheduler_tick_dense(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    std::vector<uint32_t> times(all.size());
+    DenseQueue queue{ times.data(), times.size() };
+    Scheduler scheduler{ all.data(), all.size(), queue };
+    tick(state, scheduler);
+}
+
+static std::vector<CronTask> cron_tasks(uint32_t size) {
+    std::vector<CronTask> tasks;
+    tasks.reserve(size);
+    for (auto i = 0u; i < size; ++i) {
+        tasks.emplace_back(CronSpec::specific(i % 60, (i * 7) % 60, 0xff));
+    }
+    return tasks;
+}
+
+// Every few seconds, so rescheduling after runs is most of the work.
+static void scheduler_tick_cron(State &state) {
+    std::vector<CronTask> tasks;
+    tasks.reserve(state.arg());
+    for (auto i = 0u; i < state.arg(); ++i) {
+        tasks.emplace_back(CronSpec::interval(2 + i % 9));
+    }
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    std::vector<HeapQueue::Slot> slots(all.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    Scheduler scheduler{ all.data(), all.size(), queue };
+    tick(state, scheduler);
+}
+
+// Hourly cron tasks, a quarter of them invalid, checked in batches
+// without a queue, so asking every task if it's active is most of the
+// work unless that's cached.
+static void tick_hourly(State &state, bool cached) {
+    std::vector<CronTask> tasks;
+    tasks.reserve(state.arg());
+    for (auto i = 0u; i < state.arg(); ++i) {
+        tasks.emplace_back(i % 4 == 0 ? CronSpec{ } : CronSpec::specific(i % 60, (i * 7) % 60));
+    }
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    std::vector<uint32_t> bits((all.size() + 31) / 32);
+    Scheduler scheduler{ all.data(), all.size() };
+    if (cached) {
+        scheduler.cache(bits.data(), bits.size());
+    }
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    Scheduler::TaskAndTime due[64];
+    auto fired = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        while (auto n = scheduler.check(now, due)) {
+            fired += n;
+        }
+        now += 1;
+    }
+    keep(fired);
+}
+
+static void scheduler_tick_hourly(State &state) {
+    tick_hourly(state, false);
+}
+
+static void scheduler_tick_hourly_cached(State &state) {
+    tick_hourly(state, true);
+}
+
+static void scheduler_next_task_scan(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    Scheduler scheduler{ all.data(), all.size() };
+    scheduler.begin(JacobsBirth);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        keep(scheduler.nextTask());
+    }
+}
+
+static void scheduler_next_task_heap(State &state) {
+    auto tasks = periodic_tasks(state.arg());
+    auto all = pointers(tasks);
+    std::vector<HeapQueue::Slot> slots(all.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    Scheduler scheduler{ all.data(), all.size(), queue };
+    scheduler.begin(JacobsBirth);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        keep(scheduler.nextTask());
+    }
+}
+
+static void scheduler_next_task_at(State &state) {
+    auto tasks = cron_tasks(state.arg());
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    Scheduler scheduler{ all.data(), all.size() };
+    scheduler.begin(JacobsBirth);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        keep(scheduler.nextTask(JacobsBirth + i % 86400));
+    }
+}
+
+static void scheduler_next_task_at_compiled(State &state) {
+    CompiledCronSpecs specs;
+    std::vector<CompiledCronTask> tasks;
+    tasks.reserve(state.arg());
+    for (auto i = 0u; i < state.arg(); ++i) {
+        tasks.emplace_back(specs, CronSpec::specific(i % 60, (i * 7) % 60, 0xff));
+    }
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    Scheduler scheduler{ all.data(), all.size() };
+    scheduler.begin(JacobsBirth);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        keep(scheduler.nextTask(JacobsBirth + i % 86400));
+    }
+}
+
+// The same 60 distinct specs, shared through a pool.
+static void scheduler_next_task_at_pooled(State &state) {
+    CronSpecPool::Entry entries[60];
+    CronSpecPool pool{ entries };
+    std::vector<PooledCronTask> tasks;
+    tasks.reserve(state.arg());
+    for (auto i = 0u; i < state.arg(); ++i) {
+        tasks.emplace_back(pool, CronSpec::specific(i % 60, (i * 7) % 60, 0xff));
+    }
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    Scheduler scheduler{ all.data(), all.size() };
+    scheduler.begin(JacobsBirth);
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        keep(scheduler.nextTask(JacobsBirth + i % 86400));
+    }
+}
+
+static Benchmark scheduler_next_task_scan_10{ "scheduler/next_task/scan/10", scheduler_next_task_scan, 10 };
+static Benchmark scheduler_next_task_scan_100{ "scheduler/next_task/scan/100", scheduler_next_task_scan, 100 };
+static Benchmark scheduler_next_task_scan_1k{ "scheduler/next_task/scan/1000", scheduler_next_task_scan, 1000 };
+static Benchmark scheduler_next_task_heap_10{ "scheduler/next_task/heap/10", scheduler_next_task_heap, 10 };
+static Benchmark scheduler_next_task_heap_100{ "scheduler/next_task/heap/100", scheduler_next_task_heap, 100 };
+static Benchmark scheduler_next_task_heap_1k{ "scheduler/next_task/heap/1000", scheduler_next_task_heap, 1000 };
+static Benchmark scheduler_next_task_at_10{ "scheduler/next_task_at/scan/10", scheduler_next_task_at, 10 };
+static Benchmark scheduler_next_task_at_100{ "scheduler/next_task_at/scan/100", scheduler_next_task_at, 100 };
+static Benchmark scheduler_next_task_at_1k{ "scheduler/next_task_at/scan/1000", scheduler_next_task_at, 1000 };
+static Benchmark scheduler_next_task_at_pooled_1k{ "scheduler/next_task_at/pooled/1000", scheduler_next_task_at_pooled, 1000 };
+static Benchmark scheduler_next_task_at_compiled_1k{ "scheduler/next_task_at/compiled/1000", scheduler_next_task_at_compiled, 1000 };
+static Benchmark scheduler_tick_scan_10{ "scheduler/tick/scan/10", scheduler_tick_scan, 10 };
+static Benchmark scheduler_tick_scan_100{ "scheduler/tick/scan/100", scheduler_tick_scan, 100 };
+static Benchmark scheduler_tick_scan_1k{ "scheduler/tick/scan/1000", scheduler_tick_scan, 1000 };
+static Benchmark scheduler_tick_scan_10k{ "scheduler/tick/scan/10000", scheduler_tick_scan, 10000 };
+static Benchmark scheduler_tick_scan_100k{ "scheduler/tick/scan/100000", scheduler_tick_scan, 100000 };
+static Benchmark scheduler_tick_heap_1k{ "scheduler/tick/heap/1000", scheduler_tick_heap, 1000 };
+static Benchmark scheduler_tick_heap_10k{ "scheduler/tick/heap/10000", scheduler_tick_heap, 10000 };
+static Benchmark scheduler_tick_heap_100k{ "scheduler/tick/heap/100000", scheduler_tick_heap, 100000 };
+static Benchmark scheduler_tick_wheel_1k{ "scheduler/tick/wheel/1000", scheduler_tick_wheel, 1000 };
+static Benchmark scheduler_tick_wheel_10k{ "scheduler/tick/wheel/10000", scheduler_tick_wheel, 10000 };
+static Benchmark scheduler_tick_wheel_100k{ "scheduler/tick/wheel/100000", scheduler_tick_wheel, 100000 };
+static Benchmark scheduler_tick_dense_1k{ "scheduler/tick/dense/1000", scheduler_tick_dense, 1000 };
+static Benchmark scheduler_tick_dense_10k{ "scheduler/tick/dense/10000", scheduler_tick_dense, 10000 };
+static Benchmark scheduler_tick_dense_100k{ "scheduler/tick/dense/100000", scheduler_tick_dense, 100000 };
+static Benchmark scheduler_tick_hourly_1k{ "scheduler/tick/hourly/1000", scheduler_tick_hourly, 1000 };
+static Benchmark scheduler_tick_hourly_10k{ "scheduler/tick/hourly/10000", scheduler_tick_hourly, 10000 };
+static Benchmark scheduler_tick_hourly_cached_1k{ "scheduler/tick/hourly_cached/1000", scheduler_tick_hourly_cached, 1000 };
+static Benchmark scheduler_tick_hourly_cached_10k{ "scheduler/tick/hourly_cached/10000", scheduler_tick_hourly_cached, 10000 };
+static Benchmark scheduler_tick_cron_1k{ "scheduler/tick/cron/1000", scheduler_tick_cron, 1000 };
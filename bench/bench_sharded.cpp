@@ -0,0 +1,53 @@
+#include <thread>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/sharded.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+constexpr uint32_t ShardedTasks = 100000;
+
+// One iteration is one second of wall time for every task, each shard
+// checked on its own thread, so with enough cores the time per tick
+// should fall as shards are added.
+static void sharded_tick(State &state) {
+    std::vector<PeriodicTask> tasks;
+    tasks.reserve(ShardedTasks);
+    for (auto i = 0u; i < ShardedTasks; ++i) {
+        tasks.emplace_back(10 + (i * 7919) % 300);
+    }
+
+    ShardedScheduler sharded{ state.arg() };
+    for (auto &task : tasks) {
+        sharded.add(&task, JacobsBirth);
+    }
+    sharded.begin(JacobsBirth);
+    state.reset_timer();
+
+    std::vector<std::thread> threads;
+    for (auto s = (size_t)0; s < sharded.shards(); ++s) {
+        threads.emplace_back([&, s]() {
+            auto now = JacobsBirth;
+            auto fired = (size_t)0;
+            for (auto i = 0u; i < state.iterations(); ++i) {
+                fired += sharded.check(s, now);
+                now += 1;
+            }
+            keep(fired);
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+static Benchmark sharded_tick_1{ "sharded/tick/100000/1", sharded_tick, 1 };
+static Benchmark sharded_tick_2{ "sharded/tick/100000/2", sharded_tick, 2 };
+static Benchmark sharded_tick_4{ "sharded/tick/100000/4", sharded_tick, 4 };
+static Benchmark sharded_tick_8{ "sharded/tick/100000/8", sharded_tick, 8 };
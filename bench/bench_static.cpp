@@ -0,0 +1,61 @@
+#include <lwcron/lwcron.h>
+#include <lwcron/static.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+// The sort of thing a logger runs, four readings and four uploads or
+// housekeeping jobs. One iteration is one second.
+static void static_tick_virtual(State &state) {
+    PeriodicTask p1{ 10 };
+    PeriodicTask p2{ 30 };
+    PeriodicTask p3{ 60 };
+    PeriodicTask p4{ 300 };
+    CronTask c1{ CronSpec::everyFiveMinutes() };
+    CronTask c2{ CronSpec::everyTwentyMinutes() };
+    CronTask c3{ CronSpec::specific(0, 15) };
+    CronTask c4{ CronSpec::specific(0, 0, 3) };
+    Task *tasks[] = { &p1, &p2, &p3, &p4, &c1, &c2, &c3, &c4 };
+    Scheduler scheduler{ tasks };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    Scheduler::TaskAndTime due[8];
+    auto fired = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        fired += scheduler.check(now, due);
+        now += 1;
+    }
+    keep(fired);
+}
+
+static void static_tick_static(State &state) {
+    StaticScheduler<StaticPeriodicTask, StaticPeriodicTask, StaticPeriodicTask, StaticPeriodicTask,
+                    StaticCronTask, StaticCronTask, StaticCronTask, StaticCronTask> scheduler{
+        { 10 }, { 30 }, { 60 }, { 300 },
+        { CronSpec::everyFiveMinutes() },
+        { CronSpec::everyTwentyMinutes() },
+        { CronSpec::specific(0, 15) },
+        { CronSpec::specific(0, 0, 3) },
+    };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    auto fired = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        fired += scheduler.check(now);
+        now += 1;
+    }
+    keep(fired);
+}
+
+static Benchmark static_tick_virtual_8{ "static/tick/virtual/8", static_tick_virtual };
+static Benchmark static_tick_static_8{ "static/tick/static/8", static_tick_static };
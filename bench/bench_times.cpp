@@ -0,0 +1,69 @@
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/times.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+// A tenth hourly and the rest daily, at scattered times. About twelve
+// million firings a year.
+static std::vector<CronTask> year_tasks(uint32_t size) {
+    std::vector<CronTask> tasks;
+    tasks.reserve(size);
+    for (auto i = 0u; i < size; ++i) {
+        auto hour = i % 10 == 0 ? 0xff : i % 24;
+        tasks.emplace_back(CronSpec::specific(i % 60, (i * 7) % 60, hour));
+    }
+    return tasks;
+}
+
+// One iteration is a year of every task's times, task by task.
+static void times_year_tasks(State &state) {
+    auto tasks = year_tasks(state.arg());
+    auto to = JacobsBirth + 86400 * 365;
+    state.reset_timer();
+
+    uint32_t buffer[256];
+    auto total = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        for (auto &task : tasks) {
+            FireTimes times{ task, JacobsBirth, to };
+            while (auto n = times.fill(buffer)) {
+                total += n;
+            }
+        }
+    }
+    keep(total);
+}
+
+// The same year for the whole scheduler, merged into time order.
+static void times_year_scheduler(State &state) {
+    auto tasks = year_tasks(state.arg());
+    std::vector<Task*> all;
+    for (auto &task : tasks) {
+        all.push_back(&task);
+    }
+    Scheduler scheduler{ all.data(), all.size() };
+    std::vector<HeapQueue::Slot> slots(all.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    auto to = JacobsBirth + 86400 * 365;
+    state.reset_timer();
+
+    Scheduler::TaskAndTime buffer[256];
+    auto total = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        SchedulerTimes times{ scheduler, queue, JacobsBirth, to };
+        while (auto n = times.fill(buffer)) {
+            total += n;
+        }
+    }
+    keep(total);
+}
+
+static Benchmark times_year_tasks_10k{ "times/year/tasks/10000", times_year_tasks, 10000 };
+static Benchmark times_year_scheduler_10k{ "times/year/scheduler/10000", times_year_scheduler, 10000 };
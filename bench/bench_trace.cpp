@@ -0,0 +1,68 @@
+#include <lwcron/lwcron.h>
+#include <lwcron/trace.h>
+
+#include "bench.h"
+
+using namespace lwcron;
+using namespace lwcron::bench;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+// One iteration is one second. Each records a check and about one in
+// six a task's due, run begin and run end, so tracing adds about 1.5
+// events and 1.3 clock reads a second.
+static void tick(State &state, bool traced) {
+    PeriodicTask p1{ 10 };
+    PeriodicTask p2{ 30 };
+    PeriodicTask p3{ 60 };
+    PeriodicTask p4{ 300 };
+    CronTask c1{ CronSpec::everyFiveMinutes() };
+    CronTask c2{ CronSpec::everyTwentyMinutes() };
+    CronTask c3{ CronSpec::specific(0, 15) };
+    CronTask c4{ CronSpec::specific(0, 0, 3) };
+    Task *tasks[] = { &p1, &p2, &p3, &p4, &c1, &c2, &c3, &c4 };
+    Scheduler scheduler{ tasks };
+
+    TraceEvent storage[256];
+    TraceBuffer buffer{ storage };
+    if (traced) {
+        scheduler.trace(buffer);
+    }
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    state.reset_timer();
+
+    Scheduler::TaskAndTime due[8];
+    auto fired = (size_t)0;
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        fired += scheduler.check(now, due);
+        now += 1;
+    }
+    keep(fired);
+    keep(buffer.recorded());
+}
+
+static void trace_tick_off(State &state) {
+    tick(state, false);
+}
+
+static void trace_tick_on(State &state) {
+    tick(state, true);
+}
+
+// Just recording, without the clock.
+static void trace_record(State &state) {
+    TraceEvent storage[256];
+    TraceBuffer buffer{ storage };
+    state.reset_timer();
+
+    for (auto i = 0u; i < state.iterations(); ++i) {
+        buffer.record(TraceType::Due, i, i, i & 7);
+    }
+    keep(storage);
+}
+
+static Benchmark trace_tick_off_8{ "trace/tick/off/8", trace_tick_off };
+static Benchmark trace_tick_on_8{ "trace/tick/on/8", trace_tick_on };
+static Benchmark trace_record_one{ "trace/record", trace_record };
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.h"
+
+namespace lwcron {
+
+namespace bench {
+
+constexpr uint64_t MinimumNs = 200 * 1000 * 1000;
+
+Benchmark::Benchmark(const char *name, void (*fn)(State &state), uint32_t arg) : name(name), fn(fn), arg(arg), next(head()) {
+    head() = this;
+}
+
+Benchmark *&Benchmark::head() {
+    static Benchmark *head = nullptr;
+    return head;
+}
+
+static void run(Benchmark &benchmark, bool json) {
+    auto iterations = (uint64_t)1;
+    while (true) {
+        State state{ iterations, benchmark.arg };
+        benchmark.fn(state);
+        auto elapsed = state.elapsed_ns();
+        auto elapsed_cycles = state.elapsed_cycles();
+        if (elapsed >= MinimumNs || iterations >= (1ull << 40)) {
+            auto ns = (double)elapsed / iterations;
+            auto cpo = (double)elapsed_cycles / iterations;
+            if (json) {
+                printf("{ \"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.1f, \"cycles_per_op\": %.1f }\n", benchmark.name, iterations, ns, cpo);
+            }
+            else {
+                printf("%-40s %12" PRIu64 " %14.1f ns/op %14.1f cycles/op\n", benchmark.name, iterations, ns, cpo);
+            }
+            fflush(stdout);
+            return;
+        }
+        // Aim a little past the minimum, growing by at most 10x.
+        auto scale = elapsed == 0 ? 10.0 : (MinimumNs * 1.2) / elapsed;
+        iterations = (uint64_t)(iterations * (scale > 10.0 ? 10.0 : scale)) + 1;
+    }
+}
+
+}
+
+}
+
+int main(int argc, char **argv) {
+    using namespace lwcron::bench;
+
+    // lwcron-bench [--json] [filter], --json prints one object per line.
+    auto json = false;
+    const char *filter = nullptr;
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+
+    // Registration prepends, so reverse to run in declaration order.
+    Benchmark *ordered = nullptr;
+    for (auto b = Benchmark::head(); b != nullptr; ) {
+        auto next = b->next;
+        b->next = ordered;
+        ordered = b;
+        b = next;
+    }
+
+    for (auto b = ordered; b != nullptr; b = b->next) {
+        if (filter == nullptr || strstr(b->name, filter) != nullptr) {
+            run(*b, json);
+        }
+    }
+
+    return 0;
+}
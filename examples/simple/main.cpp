@@ -1,14 +1,61 @@
 #include <Arduino.h>
 #include <lwcron/lwcron.h>
 
+using namespace lwcron;
+
+class BlinkTask : public PeriodicTask {
+public:
+    BlinkTask(uint32_t interval) : PeriodicTask(interval) {
+    }
+
+public:
+    void run() override {
+        digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+    }
+};
+
+class ReportTask : public CronTask {
+public:
+    ReportTask(CronSpec spec) : CronTask(spec) {
+    }
+
+public:
+    void run() override {
+        Serial.println("report");
+    }
+};
+
+static BlinkTask blink{ 10 };
+static ReportTask report{ CronSpec::everyFiveMinutes() };
+static Task *tasks[] = { &blink, &report };
+static Scheduler scheduler{ tasks };
+
+// Stands in for an RTC.
+static DateTime now() {
+    return DateTime{ 1982, 4, 23, 7, 30, 0 } + millis() / 1000;
+}
+
 void setup() {
     Serial.begin(119200);
 
     while (!Serial) {
         delay(100);
     }
+
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    scheduler.begin(now());
 }
 
 void loop() {
+    Scheduler::TaskAndTime due[2];
+    scheduler.check(now(), due);
 
+    // Rather than waking up every second, sleep until something's due. A
+    // logger would arm an RTC alarm and put the MCU to sleep here.
+    auto seconds = scheduler.secondsUntilNextTask(now());
+    if (seconds > 60) {
+        seconds = 60;
+    }
+    delay(seconds * 1000);
 }
@@ -0,0 +1,91 @@
+#if !defined(ARDUINO)
+
+#include "compiled.h"
+
+namespace lwcron {
+
+constexpr uint32_t CompiledCronSpec::MinutesPerDay;
+
+constexpr uint16_t NoMinute = UINT16_MAX;
+
+CompiledCronSpec::CompiledCronSpec(CronSpec spec) : spec_(spec) {
+    auto next = NoMinute;
+    for (auto i = (int32_t)MinutesPerDay - 1; i >= 0; --i) {
+        if (bitarray_test(spec.hours, i / 60) && bitarray_test(spec.minutes, i % 60)) {
+            next = i;
+        }
+        next_minute_[i] = next;
+    }
+
+    // Past the last match of the day, it's the first one tomorrow.
+    auto first = next_minute_[0];
+    for (auto &minute : next_minute_) {
+        if (minute == NoMinute && first != NoMinute) {
+            minute = first + MinutesPerDay;
+        }
+    }
+    next_minute_[MinutesPerDay] = first == NoMinute ? NoMinute : first + MinutesPerDay;
+
+    first_second_ = bitarray_next(spec.seconds, 0, 60);
+}
+
+uint32_t CompiledCronSpec::getNextTime(DateTime after) const {
+    if (first_second_ < 0 || next_minute_[0] == NoMinute) {
+        return 0;
+    }
+
+    auto unix_time = after.unix_time();
+    auto second_of_day = unix_time % SecondsPerDay;
+    auto midnight = unix_time - second_of_day;
+    auto minute = second_of_day / 60;
+
+    if (next_minute_[minute] == minute) {
+        auto second = second_of_day % 60;
+        auto next_second = bitarray_next(spec_.seconds, second, 60);
+        if (next_second >= 0) {
+            return unix_time + (next_second - second);
+        }
+        minute++;
+    }
+
+    return midnight + next_minute_[minute] * 60 + first_second_;
+}
+
+CompiledCronSpec const *CompiledCronSpecs::get(CronSpec spec) {
+    std::lock_guard<std::mutex> guard{ lock_ };
+    for (auto &compiled : specs_) {
+        if (compiled->spec() == spec) {
+            return compiled.get();
+        }
+    }
+    specs_.emplace_back(new CompiledCronSpec(spec));
+    return specs_.back().get();
+}
+
+size_t CompiledCronSpecs::size() const {
+    std::lock_guard<std::mutex> guard{ lock_ };
+    return specs_.size();
+}
+
+size_t CompiledCronSpecs::memory() const {
+    std::lock_guard<std::mutex> guard{ lock_ };
+    return specs_.size() * sizeof(CompiledCronSpec) + specs_.capacity() * sizeof(specs_[0]);
+}
+
+uint32_t CompiledCronTask::getNextTime(DateTime after, uint32_t seed) const {
+    auto compiled = compiled_.load(std::memory_order_acquire);
+    if (compiled == nullptr) {
+        compiled = specs_->get(spec());
+        compiled_.store(compiled, std::memory_order_release);
+    }
+
+    return jittered(compiled->getNextTime(after), jitter(), seed);
+}
+
+uint32_t CompiledCronTask::getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+    return getNextTime(after, seed);
+}
+
+}
+
+#endif
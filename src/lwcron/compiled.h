@@ -0,0 +1,83 @@
+#ifndef LWCRON_COMPILED_H_INCLUDED
+#define LWCRON_COMPILED_H_INCLUDED
+
+// Each table is a few kilobytes, too much for the MCU, so hosted builds
+// only.
+#if !defined(ARDUINO)
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// A CronSpec with, for every minute of the day, the next minute that
+// matches, so getNextTime is a table lookup and a bit scan of seconds.
+class CompiledCronSpec {
+public:
+    static constexpr uint32_t MinutesPerDay = 24 * 60;
+
+private:
+    CronSpec spec_;
+    int32_t first_second_{ -1 };
+    // Minute of the day, or of the following day past MinutesPerDay. The
+    // extra one at the end is for carrying out of the last minute.
+    uint16_t next_minute_[MinutesPerDay + 1];
+
+public:
+    CompiledCronSpec(CronSpec spec);
+
+public:
+    CronSpec spec() const {
+        return spec_;
+    }
+
+    uint32_t getNextTime(DateTime after) const;
+
+};
+
+// Compiled specs shared by everything using the same CronSpec, built the
+// first time one's asked for. Safe to use from multiple threads.
+class CompiledCronSpecs {
+private:
+    mutable std::mutex lock_;
+    std::vector<std::unique_ptr<CompiledCronSpec>> specs_;
+
+public:
+    CompiledCronSpec const *get(CronSpec spec);
+
+    size_t size() const;
+
+    // Bytes used by the tables.
+    size_t memory() const;
+
+};
+
+// A CronTask that looks its times up in a shared compiled spec.
+class CompiledCronTask : public CronTask {
+private:
+    CompiledCronSpecs *specs_;
+    mutable std::atomic<CompiledCronSpec const*> compiled_{ nullptr };
+
+public:
+    CompiledCronTask(CompiledCronSpecs &specs, CronSpec spec, uint32_t jitter = 0) : CronTask(spec, jitter), specs_(&specs) {
+    }
+
+    CompiledCronTask(CompiledCronTask const &other) : CronTask(other), specs_(other.specs_), compiled_(other.compiled_.load()) {
+    }
+
+public:
+    uint32_t getNextTime(DateTime after, uint32_t seed) const override;
+    // A lookup is as cheap as stepping on from previous.
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const override;
+
+};
+
+}
+
+#endif
+
+#endif
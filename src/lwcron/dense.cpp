@@ -0,0 +1,144 @@
+#include "dense.h"
+
+#if !defined(LWCRON_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LWCRON_DENSE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LWCRON_DENSE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LWCRON_DENSE_NEON
+#endif
+#endif
+
+namespace lwcron {
+
+constexpr uint32_t DenseQueue::None;
+
+size_t DenseQueue::due(uint32_t const *times, size_t from, size_t size, uint32_t now) {
+    auto i = from;
+
+#if defined(LWCRON_DENSE_AVX2)
+    // There's no unsigned compare, flipping the sign bits makes a signed
+    // one give the same answer.
+    auto bias = _mm256_set1_epi32(INT32_MIN);
+    auto limit = _mm256_xor_si256(_mm256_set1_epi32((int32_t)now), bias);
+    for (; i + 8 <= size; i += 8) {
+        auto values = _mm256_xor_si256(_mm256_loadu_si256((__m256i const *)(times + i)), bias);
+        auto later = _mm256_cmpgt_epi32(values, limit);
+        auto mask = ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(later)) & 0xff;
+        if (mask != 0) {
+            return i + bits_ctz(mask);
+        }
+    }
+#elif defined(LWCRON_DENSE_SSE2)
+    auto bias = _mm_set1_epi32(INT32_MIN);
+    auto limit = _mm_xor_si128(_mm_set1_epi32((int32_t)now), bias);
+    for (; i + 4 <= size; i += 4) {
+        auto values = _mm_xor_si128(_mm_loadu_si128((__m128i const *)(times + i)), bias);
+        auto later = _mm_cmpgt_epi32(values, limit);
+        auto mask = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(later)) & 0xf;
+        if (mask != 0) {
+            return i + bits_ctz(mask);
+        }
+    }
+#elif defined(LWCRON_DENSE_NEON)
+    auto limit = vdupq_n_u32(now);
+    for (; i + 4 <= size; i += 4) {
+        // Which of the four is left to the loop below.
+        if (vmaxvq_u32(vcleq_u32(vld1q_u32(times + i), limit)) != 0) {
+            break;
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        if (times[i] <= now) {
+            return i;
+        }
+    }
+    return size;
+}
+
+void DenseQueue::clear(uint32_t now) {
+    for (auto i = (size_t)0; i < capacity_; ++i) {
+        times_[i] = None;
+    }
+    size_ = 0;
+    scan_now_ = now;
+    scan_from_ = 0;
+}
+
+bool DenseQueue::push(uint32_t index, uint32_t time) {
+    if (index >= capacity_) {
+        return false;
+    }
+    if (times_[index] == None) {
+        size_++;
+    }
+    times_[index] = time;
+    // Due behind where this tick's scan has got to.
+    if (time <= scan_now_ && index < scan_from_) {
+        scan_from_ = index;
+    }
+    return true;
+}
+
+bool DenseQueue::peek(uint32_t &index, uint32_t &time) {
+    auto earliest = None;
+    auto found = capacity_;
+    for (auto i = (size_t)0; i < capacity_; ++i) {
+        if (times_[i] < earliest) {
+            earliest = times_[i];
+            found = i;
+        }
+    }
+    if (found == capacity_) {
+        return false;
+    }
+    index = found;
+    time = earliest;
+    return true;
+}
+
+bool DenseQueue::pop(uint32_t now, uint32_t &index) {
+    if (now != scan_now_) {
+        scan_now_ = now;
+        scan_from_ = 0;
+    }
+
+    auto i = due(times_, scan_from_, capacity_, now);
+    if (i == capacity_) {
+        scan_from_ = capacity_;
+        return false;
+    }
+
+    times_[i] = None;
+    size_--;
+    scan_from_ = i + 1;
+    index = i;
+    return true;
+}
+
+bool DenseQueue::remove(uint32_t index) {
+    if (index >= capacity_ || times_[index] == None) {
+        return false;
+    }
+    times_[index] = None;
+    size_--;
+    return true;
+}
+
+bool DenseQueue::move(uint32_t from, uint32_t to) {
+    if (from >= capacity_ || to >= capacity_ || times_[from] == None || times_[to] != None) {
+        return false;
+    }
+    auto time = times_[from];
+    times_[from] = None;
+    size_--;
+    return push(to, time);
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef LWCRON_DENSE_H_INCLUDED
+#define LWCRON_DENSE_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Every task's scheduled time in one array indexed like the tasks, with
+// unqueued slots holding None. Finding what's due is a linear scan of
+// that array for times at or before now, done 4 or 8 at a time with
+// SSE2, AVX2 or NEON where there is one, so a tick only reads the tasks
+// that are due rather than following a pointer to every one. Pops go
+// lowest index first, like Scheduler without a queue, and a tick's scan
+// carries on from where the last pop stopped, so checking is one pass
+// over the array however many tasks are due.
+class DenseQueue : public TaskQueue {
+public:
+    static constexpr uint32_t None = UINT32_MAX;
+
+private:
+    uint32_t *times_{ nullptr };
+    size_t capacity_{ 0 };
+    size_t size_{ 0 };
+    uint32_t scan_now_{ 0 };
+    size_t scan_from_{ 0 };
+
+public:
+    DenseQueue(uint32_t *times, size_t capacity) : times_(times), capacity_(capacity) {
+        clear(0);
+    }
+
+    template<size_t N>
+    DenseQueue(uint32_t (&times)[N]) : DenseQueue(&times[0], N) {
+    }
+
+public:
+    size_t size() const {
+        return size_;
+    }
+
+public:
+    void clear(uint32_t now) override;
+    bool push(uint32_t index, uint32_t time) override;
+    bool peek(uint32_t &index, uint32_t &time) override;
+    bool pop(uint32_t now, uint32_t &index) override;
+    bool remove(uint32_t index) override;
+    bool move(uint32_t from, uint32_t to) override;
+
+public:
+    // First index from from with a time at or before now, or size.
+    static size_t due(uint32_t const *times, size_t from, size_t size, uint32_t now);
+
+};
+
+}
+
+#endif
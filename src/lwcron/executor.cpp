@@ -0,0 +1,201 @@
+#if !defined(ARDUINO)
+
+#include "executor.h"
+
+namespace lwcron {
+
+constexpr size_t CollectBatchSize = 16;
+
+enum : uint8_t {
+    Idle = 0,
+    Running = 1,
+    Pending = 2,
+};
+
+bool Executor::start() {
+    if (size_ == 0 || !workers_.empty()) {
+        return false;
+    }
+
+    stopping_ = false;
+
+    for (auto i = (size_t)0; i < size_; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (auto i = (size_t)0; i < size_; ++i) {
+        workers_[i]->thread = std::thread{ &Executor::work, this, i };
+    }
+
+    return true;
+}
+
+void Executor::stop() {
+    if (workers_.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+
+    for (auto &worker : workers_) {
+        worker->thread.join();
+    }
+    workers_.clear();
+}
+
+size_t Executor::check(DateTime now, uint32_t seed) {
+    auto queued = (size_t)0;
+
+    while (true) {
+        Scheduler::TaskAndTime due[CollectBatchSize];
+        auto n = scheduler_->check(now, due, seed, Scheduler::Dispatch::Collect);
+        for (auto i = (size_t)0; i < n; ++i) {
+            if (submit(due[i].task)) {
+                queued++;
+            }
+        }
+        if (n < CollectBatchSize) {
+            break;
+        }
+    }
+
+    return queued;
+}
+
+void Executor::wait() {
+    std::unique_lock<std::mutex> guard{ lock_ };
+    idle_.wait(guard, [this]() {
+        return queued_ == 0 && active_ == 0;
+    });
+}
+
+Executor::Stats Executor::stats() const {
+    return Stats{ runs_, skipped_, coalesced_ };
+}
+
+bool Executor::submit(Task *task) {
+    if (workers_.empty()) {
+        return false;
+    }
+
+    std::atomic<uint8_t> *state = nullptr;
+
+    if (overlap_ != Overlap::Allow) {
+        // Only ever touched from this thread, and elements never move, so
+        // workers can keep a pointer to their task's state.
+        state = &states_[task];
+
+        // Either Idle to Running, or Running to Running and Pending, in
+        // one exchange. Setting Pending separately could land just after
+        // the run finished and leave it set with nothing running.
+        uint8_t expected = Idle;
+        while (true) {
+            if (expected == Idle) {
+                if (state->compare_exchange_weak(expected, Running)) {
+                    break;
+                }
+                continue;
+            }
+            if (overlap_ != Overlap::Coalesce) {
+                skipped_++;
+                return false;
+            }
+            if (state->compare_exchange_weak(expected, (uint8_t)(expected | Pending))) {
+                coalesced_++;
+                return false;
+            }
+        }
+    }
+
+    // Counted before it's visible so a worker that finds it never takes
+    // queued_ below zero.
+    queued_++;
+
+    auto &worker = *workers_[next_];
+    next_ = (next_ + 1) % workers_.size();
+    {
+        std::lock_guard<std::mutex> guard{ worker.lock };
+        worker.jobs.push_back(Job{ task, state });
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+    }
+    wakeup_.notify_one();
+
+    return true;
+}
+
+bool Executor::take(size_t index, Job &job) {
+    // Oldest of our own first, then the newest from everybody else.
+    for (auto i = (size_t)0; i < workers_.size(); ++i) {
+        auto &worker = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> guard{ worker.lock };
+        if (!worker.jobs.empty()) {
+            if (i == 0) {
+                job = worker.jobs.front();
+                worker.jobs.pop_front();
+            }
+            else {
+                job = worker.jobs.back();
+                worker.jobs.pop_back();
+            }
+            active_++;
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::work(size_t index) {
+    while (true) {
+        Job job;
+        if (take(index, job)) {
+            execute(job);
+
+            if (--active_ == 0 && queued_ == 0) {
+                std::lock_guard<std::mutex> guard{ lock_ };
+                idle_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard{ lock_ };
+        if (queued_ > 0) {
+            // Counted, but not pushed yet.
+            guard.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (stopping_) {
+            return;
+        }
+        wakeup_.wait(guard);
+    }
+}
+
+void Executor::execute(Job job) {
+    while (true) {
+        job.task->run();
+        runs_++;
+
+        if (job.state == nullptr) {
+            return;
+        }
+
+        // Done, unless the task came due again while running.
+        uint8_t expected = Running;
+        if (job.state->compare_exchange_strong(expected, Idle)) {
+            return;
+        }
+        job.state->fetch_and((uint8_t)~Pending);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef LWCRON_EXECUTOR_H_INCLUDED
+#define LWCRON_EXECUTOR_H_INCLUDED
+
+// Needs threads, so hosted builds only.
+#if !defined(ARDUINO)
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Runs due tasks on a fixed pool of worker threads instead of inline in
+// Scheduler::check, so one slow task can't hold up the others or make
+// the scheduler late. Each worker has its own deque, idle workers steal
+// from the others. Call check from one thread, usually wherever
+// Scheduler::check was called before.
+class Executor {
+public:
+    // What to do when a task comes due again while a previous run of it
+    // is still going.
+    enum class Overlap {
+        // Drop the new run.
+        Skip,
+        // Run once more after the current run, however many came due.
+        Coalesce,
+        // Run concurrently with itself.
+        Allow,
+    };
+
+    struct Stats {
+        uint64_t runs;
+        uint64_t skipped;
+        uint64_t coalesced;
+    };
+
+private:
+    struct Job {
+        Task *task;
+        std::atomic<uint8_t> *state;
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    Scheduler *scheduler_;
+    size_t size_;
+    Overlap overlap_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unordered_map<Task*, std::atomic<uint8_t>> states_;
+    size_t next_{ 0 };
+
+    std::mutex lock_;
+    std::condition_variable wakeup_;
+    std::condition_variable idle_;
+    std::atomic<int32_t> queued_{ 0 };
+    std::atomic<int32_t> active_{ 0 };
+    std::atomic<bool> stopping_{ false };
+
+    std::atomic<uint64_t> runs_{ 0 };
+    std::atomic<uint64_t> skipped_{ 0 };
+    std::atomic<uint64_t> coalesced_{ 0 };
+
+public:
+    Executor(Scheduler &scheduler, size_t workers, Overlap overlap = Overlap::Skip) :
+        scheduler_(&scheduler), size_(workers), overlap_(overlap) {
+    }
+
+    ~Executor() {
+        stop();
+    }
+
+public:
+    size_t workers() const {
+        return size_;
+    }
+
+    Overlap overlap() const {
+        return overlap_;
+    }
+
+public:
+    bool start();
+
+    // Lets queued runs finish and joins the workers.
+    void stop();
+
+    // Collects every due task from the scheduler and hands them to the
+    // workers. Returns how many were queued, skipped ones aren't counted.
+    size_t check(DateTime now, uint32_t seed = 0);
+
+    // Blocks until nothing is queued or running.
+    void wait();
+
+    Stats stats() const;
+
+private:
+    bool submit(Task *task);
+    bool take(size_t index, Job &job);
+    void work(size_t index);
+    void execute(Job job);
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef LWCRON_EXPRESSION_H_INCLUDED
+#define LWCRON_EXPRESSION_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Compile time parsing of "seconds minutes hours" cron expressions, see
+// CronSpec::parse for the syntax. Everything here is C++11 constexpr, so
+// no locals and each step hands its result on to the next function
+// rather than computing it twice. Using an invalid expression where a
+// constant is required fails to compile, at runtime it gives an empty,
+// invalid CronSpec.
+namespace expression {
+
+struct Parsed {
+    uint64_t value;
+    uint32_t end;
+    bool ok;
+};
+
+constexpr Parsed failed() {
+    return Parsed{ 0, 0, false };
+}
+
+constexpr bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+constexpr uint32_t skip(const char *s, uint32_t i) {
+    return is_space(s[i]) ? skip(s, i + 1) : i;
+}
+
+constexpr Parsed number(const char *s, uint32_t i, uint64_t value = 0, bool any = false) {
+    return value > 99 ? failed() :
+           is_digit(s[i]) ? number(s, i + 1, value * 10 + (s[i] - '0'), true) :
+           Parsed{ value, i, any };
+}
+
+constexpr uint64_t bits(uint64_t from, uint64_t to, uint64_t step) {
+    return from > to ? 0 : ((uint64_t)1 << from) | bits(from + step, to, step);
+}
+
+constexpr Parsed stepped(uint64_t from, uint64_t to, Parsed step) {
+    return !step.ok || step.value == 0 ? failed() : Parsed{ bits(from, to, step.value), step.end, true };
+}
+
+constexpr Parsed step(const char *s, uint32_t i, uint64_t from, uint64_t to) {
+    return s[i] == '/' ? stepped(from, to, number(s, i + 1)) : Parsed{ bits(from, to, 1), i, true };
+}
+
+constexpr Parsed range(const char *s, uint64_t from, Parsed to, uint32_t max) {
+    return !to.ok || to.value >= max || to.value < from ? failed() : step(s, to.end, from, to.value);
+}
+
+constexpr Parsed start(const char *s, Parsed from, uint32_t max) {
+    return !from.ok || from.value >= max ? failed() :
+           s[from.end] == '-' ? range(s, from.value, number(s, from.end + 1), max) :
+           s[from.end] == '/' ? step(s, from.end, from.value, max - 1) :
+           Parsed{ (uint64_t)1 << from.value, from.end, true };
+}
+
+constexpr Parsed item(const char *s, uint32_t i, uint32_t max) {
+    return s[i] == '*' ? step(s, i + 1, 0, max - 1) : start(s, number(s, i), max);
+}
+
+constexpr Parsed list(const char *s, Parsed parsed, uint64_t bits, uint32_t max) {
+    return !parsed.ok ? parsed :
+           s[parsed.end] == ',' ? list(s, item(s, parsed.end + 1, max), bits | parsed.value, max) :
+           Parsed{ bits | parsed.value, parsed.end, true };
+}
+
+constexpr Parsed field(const char *s, uint32_t i, uint32_t max) {
+    return list(s, item(s, i, max), 0, max);
+}
+
+// Deliberately not constexpr.
+inline CronSpec invalid() {
+    return CronSpec{ };
+}
+
+constexpr CronSpec hours(const char *s, uint64_t seconds, uint64_t minutes, Parsed hours) {
+    return !hours.ok || s[skip(s, hours.end)] != 0 ? invalid() : CronSpec::bits(seconds, minutes, (uint32_t)hours.value);
+}
+
+constexpr CronSpec minutes(const char *s, uint64_t seconds, Parsed minutes) {
+    return !minutes.ok || !is_space(s[minutes.end]) ? invalid() : hours(s, seconds, minutes.value, field(s, skip(s, minutes.end), 24));
+}
+
+constexpr CronSpec seconds(const char *s, Parsed seconds) {
+    return !seconds.ok || !is_space(s[seconds.end]) ? invalid() : minutes(s, seconds.value, field(s, skip(s, seconds.end), 60));
+}
+
+constexpr CronSpec parse(const char *s) {
+    return seconds(s, field(s, skip(s, 0), 60));
+}
+
+}
+
+namespace literals {
+
+constexpr CronSpec operator"" _cron(const char *s, size_t) {
+    return expression::parse(s);
+}
+
+}
+
+}
+
+#endif
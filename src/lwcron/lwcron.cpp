@@ -1,89 +1,71 @@
 #include "lwcron.h"
+#include "trace.h"
 #include <stdio.h>
 
-namespace lwcron {
-
-constexpr uint32_t SecondsPerYear = (60 * 60 * 24L * 365);
-constexpr uint32_t SecondsPerDay = 60 * 60 * 24L;
-constexpr uint32_t SecondsPerHour = 3600L;
-constexpr uint32_t RerunThreshold = 30;
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <time.h>
+#endif
 
-constexpr uint8_t DaysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+namespace lwcron {
 
-constexpr bool is_leap_year(uint16_t year) {
-    return year % 4 == 0;
+// Conversions between civil dates and days since 1970-01-01, see
+// http://howardhinnant.github.io/date_algorithms.html. Years are counted
+// from March so that the leap day falls at the end, and the Gregorian
+// leap rule comes out of the 400 year era arithmetic. Dates before 1970
+// aren't supported so all of this can stay unsigned.
+constexpr uint32_t DaysPerEra = 146097;
+constexpr uint32_t DaysFromEpochToMarch0000 = 719468;
+
+static inline uint32_t days_from_civil(uint32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    auto era = year / 400;
+    auto yoe = year - era * 400;
+    auto doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * DaysPerEra + doe - DaysFromEpochToMarch0000;
 }
 
-DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) :
-    year_(year), month_(month - 1), day_(day), hour_(hour), minute_(minute), second_(second) {
+static inline void civil_from_days(uint32_t days, uint16_t &year, uint8_t &month, uint8_t &day) {
+    days += DaysFromEpochToMarch0000;
+    auto era = days / DaysPerEra;
+    auto doe = days - era * DaysPerEra;
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    auto m = mp < 10 ? mp + 3 : mp - 9;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = m;
+    year = yoe + era * 400 + (m <= 2);
 }
 
-DateTime::DateTime(uint32_t unix_time) {
-    auto t = unix_time;
-
-    TimeOfDay tod{ t };
-    second_ = tod.second;
-    minute_ = tod.minute;
-    hour_ = tod.hour;
-    t = tod.remainder;
-
-    auto year = 70;
-    auto days = 0;
-    while ((uint16_t)(days += (is_leap_year(year) ? 366 : 365)) <= t) {
-        year++;
-    }
-
-    year_ = year + 1900;
-    days -= is_leap_year(year) ? 366 : 365;
-    t -= days;
-
-    auto month = 0;
-    auto length = 0;
-    for (month = 0; month < 12; month++) {
-        if (month == 1) { // february
-            if (is_leap_year(year)) {
-                length = 29;
-            } else {
-                length = 28;
-            }
-        } else {
-            length = DaysInMonth[month];
-        }
-
-        if (t >= length) {
-            t -= length;
-        }
-        else {
-            break;
-        }
-    }
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    time_ = days_from_civil(year, month, day) * SecondsPerDay;
+    time_ += hour * SecondsPerHour;
+    time_ += minute * 60L;
+    time_ += second;
+}
 
-    month_ = month;
-    day_ = t + 1;
+uint16_t DateTime::year() const {
+    uint16_t year;
+    uint8_t month, day;
+    civil_from_days(time_ / SecondsPerDay, year, month, day);
+    return year;
 }
 
-uint32_t DateTime::unix_time() {
-    auto year = year_;
-    auto seconds = (year - 1970) * SecondsPerYear;
-    for (auto i = 1970; i < year; i++) {
-        if (is_leap_year(i)) {
-            seconds += SecondsPerDay;
-        }
-    }
-    for (auto i = 0; i < month_; i++) {
-        if (i == 1 && is_leap_year(year)) {
-            seconds += SecondsPerDay * 29;
-        }
-        else {
-            seconds += SecondsPerDay * DaysInMonth[i];
-        }
-    }
+uint8_t DateTime::month() const {
+    uint16_t year;
+    uint8_t month, day;
+    civil_from_days(time_ / SecondsPerDay, year, month, day);
+    return month;
+}
 
-    seconds += (day_ - 1) * SecondsPerDay;
-    seconds += hour_ * SecondsPerHour;
-    seconds += minute_ * 60L;
-    seconds += second_;
-    return seconds;
+uint8_t DateTime::day() const {
+    uint16_t year;
+    uint8_t month, day;
+    civil_from_days(time_ / SecondsPerDay, year, month, day);
+    return day;
 }
 
 void PeriodicTask::run() {
@@ -98,70 +80,114 @@ bool PeriodicTask::enabled() const {
 }
 
 uint32_t PeriodicTask::getNextTime(DateTime after, uint32_t seed) const {
-    auto seconds = after.unix_time();
-    auto r = seconds % interval_;
-    if (r == 0) {
-        return seconds;
-    }
-    return seconds + (interval_ - r);
+    return periodic_next_time(interval_, after.unix_time());
 }
 
-CronSpec CronSpec::interval(uint32_t seconds) {
-    CronSpec cs;
+uint32_t PeriodicTask::getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+    return periodic_next_time_from(interval_, previous, after.unix_time());
+}
+
+constexpr uint64_t CronSpec::AllSeconds;
+constexpr uint64_t CronSpec::AllMinutes;
+constexpr uint32_t CronSpec::AllHours;
 
-    if (seconds > 0) {
-        for (auto s = 0u; s <= SecondsPerDay; s += seconds) {
-            TimeOfDay tod{ s };
-            cs.set(tod);
+static const char *parse_number(const char *p, uint32_t &value) {
+    if (*p < '0' || *p > '9') {
+        return nullptr;
+    }
+    value = 0;
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + (*p++ - '0');
+        if (value > 99) {
+            return nullptr;
         }
     }
-
-    return cs;
+    return p;
 }
 
-CronSpec CronSpec::specific(uint8_t second, uint8_t minute, uint8_t hour) {
-    CronSpec cs;
-    bitarray_set(cs.seconds, second);
-    if (minute == 0xff) {
-        memset(cs.minutes, 0xff, sizeof(cs.minutes));
-    }
-    else {
-        bitarray_set(cs.minutes, minute);
-    }
-    if (hour == 0xff) {
-        memset(cs.hours, 0xff, sizeof(cs.hours));
-    }
-    else {
-        bitarray_set(cs.hours, hour);
+static const char *parse_field(const char *p, uint32_t max, uint64_t &bits) {
+    bits = 0;
+    while (true) {
+        uint32_t from = 0;
+        uint32_t to = max - 1;
+        uint32_t step = 1;
+        if (*p == '*') {
+            p++;
+        }
+        else {
+            p = parse_number(p, from);
+            if (p == nullptr || from >= max) {
+                return nullptr;
+            }
+            if (*p == '-') {
+                p = parse_number(p + 1, to);
+                if (p == nullptr || to >= max || to < from) {
+                    return nullptr;
+                }
+            }
+            else if (*p != '/') {
+                to = from;
+            }
+        }
+        if (*p == '/') {
+            p = parse_number(p + 1, step);
+            if (p == nullptr || step == 0) {
+                return nullptr;
+            }
+        }
+
+        if (step == 1) {
+            bits |= (((uint64_t)2 << to) - 1) & ~(((uint64_t)1 << from) - 1);
+        }
+        else {
+            for (auto i = from; i <= to; i += step) {
+                bits |= (uint64_t)1 << i;
+            }
+        }
+
+        if (*p != ',') {
+            return p;
+        }
+        p++;
     }
-    return cs;
 }
 
-
-CronSpec CronSpec::everyFiveMinutes() {
-    CronSpec cs;
-    bitarray_set(cs.seconds, 0);
-    for (auto i = 0; i < 60; i += 5) {
-        bitarray_set(cs.minutes, i);
+static const char *skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') {
+        p++;
     }
-    memset(cs.hours, 0xff, sizeof(cs.hours));
-    return cs;
+    return p;
 }
 
-CronSpec CronSpec::everyTwentyMinutes() {
-    CronSpec cs;
-    bitarray_set(cs.seconds, 0);
-    for (auto i = 0; i < 60; i += 20) {
-        bitarray_set(cs.minutes, i);
+bool CronSpec::parse(const char *expression, CronSpec &spec) {
+    uint64_t fields[3];
+    uint32_t const limits[3] = { 60, 60, 24 };
+    auto p = skip_spaces(expression);
+    for (auto i = 0; i < 3; ++i) {
+        if (i > 0) {
+            auto after = skip_spaces(p);
+            if (after == p) {
+                return false;
+            }
+            p = after;
+        }
+        p = parse_field(p, limits[i], fields[i]);
+        if (p == nullptr) {
+            return false;
+        }
+    }
+    if (*skip_spaces(p) != 0) {
+        return false;
     }
-    memset(cs.hours, 0xff, sizeof(cs.hours));
-    return cs;
+
+    spec = bits(fields[0], fields[1], (uint32_t)fields[2]);
+    return true;
 }
 
 void CronSpec::clear() {
-    bzero(&hours, sizeof(hours));
-    bzero(&minutes, sizeof(minutes));
-    bzero(&seconds, sizeof(seconds));
+    hours = 0;
+    minutes = 0;
+    seconds = 0;
 }
 
 void CronSpec::set(TimeOfDay tod) {
@@ -178,12 +204,89 @@ bool CronTask::enabled() const {
     return true;
 }
 
-// NOTE: This could be so much better.
 uint32_t CronSpec::getNextTime(DateTime after) const {
     if (!valid()) {
         return 0;
     }
 
+    auto first_second = bitarray_next(seconds, 0, 60);
+    auto first_minute = bitarray_next(minutes, 0, 60);
+    auto first_hour = bitarray_next(hours, 0, 24);
+    if (first_second < 0 || first_minute < 0 || first_hour < 0) {
+        return 0;
+    }
+
+    auto unix_time = after.unix_time();
+    TimeOfDay tod{ unix_time };
+    auto midnight = unix_time - (unix_time % SecondsPerDay);
+
+    // Find the next second in this minute, carrying into the following
+    // minute (and hour, and day) when a field runs out of set bits.
+    // Whenever a field moves forward every field below it starts over.
+    auto minute = tod.minute;
+    auto hour = tod.hour;
+
+    auto second = bitarray_next(seconds, tod.second, 60);
+    if (second < 0) {
+        second = first_second;
+        minute++;
+    }
+
+    auto next_minute = bitarray_next(minutes, minute, 60);
+    if (next_minute != minute) {
+        second = first_second;
+    }
+    if (next_minute < 0) {
+        next_minute = first_minute;
+        hour++;
+    }
+
+    auto next_hour = bitarray_next(hours, hour, 24);
+    if (next_hour != hour) {
+        next_minute = first_minute;
+        second = first_second;
+    }
+    if (next_hour < 0) {
+        next_hour = first_hour;
+        midnight += SecondsPerDay;
+    }
+
+    return midnight + next_hour * SecondsPerHour + next_minute * 60 + second;
+}
+
+uint32_t CronSpec::getFollowingTime(uint32_t previous) const {
+    auto second = previous % 60;
+    auto minute = (previous / 60) % 60;
+    auto hour = (previous / 3600) % 24;
+    if (!bitarray_test(seconds, second) || !bitarray_test(minutes, minute) || !bitarray_test(hours, hour)) {
+        return 0;
+    }
+
+    auto next_second = bitarray_next(seconds, second + 1, 60);
+    if (next_second >= 0) {
+        return previous + (next_second - second);
+    }
+
+    auto first_second = bitarray_next(seconds, 0, 60);
+    auto next_minute = bitarray_next(minutes, minute + 1, 60);
+    if (next_minute >= 0) {
+        return previous - second + (next_minute - minute) * 60 + first_second;
+    }
+
+    auto next_hour = bitarray_next(hours, hour + 1, 24);
+    if (next_hour >= 0) {
+        auto hour_start = previous - second - minute * 60;
+        return hour_start + (next_hour - hour) * SecondsPerHour + bitarray_next(minutes, 0, 60) * 60 + first_second;
+    }
+
+    return 0;
+}
+
+uint32_t CronSpec::getNextTimeReference(DateTime after) const {
+    if (!valid()) {
+        return 0;
+    }
+
     auto unix_time = after.unix_time();
     DateTime date_time{ unix_time };
     auto hour = date_time.hour();
@@ -199,14 +302,19 @@ uint32_t CronSpec::getNextTime(DateTime after) const {
             return unix_time + seconds;
         }
 
+        // Skip to the start of the next hour or minute, an earlier second
+        // in the next minute may match.
         if (matches_seconds(cs)) {
             if (matches_minutes(cs)) {
+                seconds += 3600 - minute * 60 - second;
                 hour++;
-                seconds += 3600;
+                minute = 0;
+                second = 0;
             }
             else {
+                seconds += 60 - second;
                 minute++;
-                seconds += 60;
+                second = 0;
             }
         }
         else {
@@ -240,14 +348,232 @@ bool CronTask::valid() const {
 }
 
 uint32_t CronTask::getNextTime(DateTime after, uint32_t seed) const {
-    auto unjittered = spec_.getNextTime(after);
-    if (jitter_ == 0 || seed == 0) {
-        return unjittered;
+    return jittered(spec_.getNextTime(after), jitter_, seed);
+}
+
+uint32_t CronTask::getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+    return cron_next_time_from(spec_, jitter_, previous, after, seed);
+}
+
+uint32_t cron_next_time_from(CronSpec const &spec, uint32_t jitter, uint32_t previous, DateTime after, uint32_t seed) {
+    // Jittered times aren't ones the spec matches.
+    if (jitter == 0 || seed == 0) {
+        auto following = spec.getFollowingTime(previous);
+        if (following != 0 && previous < after.unix_time() && following >= after.unix_time()) {
+            return following;
+        }
+    }
+    return jittered(spec.getNextTime(after), jitter, seed);
+}
+
+constexpr uint32_t CronSpecPool::None;
+
+uint32_t CronSpecPool::intern(CronSpec spec) {
+    for (auto i = (size_t)0; i < size_; ++i) {
+        if (entries_[i].spec == spec) {
+            return i;
+        }
     }
-    return unjittered + (seed % jitter_);
+    if (size_ == capacity_) {
+        return None;
+    }
+    entries_[size_] = Entry{ spec, 0, 0 };
+    return size_++;
+}
+
+uint32_t CronSpecPool::getNextTime(uint32_t index, DateTime after) {
+    auto &entry = entries_[index];
+    if (entry.next == 0 || entry.after != after.unix_time()) {
+        entry.after = after.unix_time();
+        entry.next = entry.spec.getNextTime(after);
+        misses_++;
+    }
+    return entry.next;
+}
+
+uint32_t PooledCronTask::getNextTime(DateTime after, uint32_t seed) const {
+    if (entry_ == CronSpecPool::None) {
+        return CronTask::getNextTime(after, seed);
+    }
+    return jittered(pool_->getNextTime(entry_, after), jitter(), seed);
+}
+
+uint32_t PooledCronTask::getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+    // Tasks run in the same tick share the pool's answer, which is
+    // cheaper than stepping each of them on.
+    if (entry_ == CronSpecPool::None) {
+        return CronTask::getNextTimeFrom(previous, after, seed);
+    }
+    return getNextTime(after, seed);
+}
+
+constexpr uint32_t HeapNone = UINT32_MAX;
+
+static inline bool heap_before(uint32_t time_a, uint32_t index_a, uint32_t time_b, uint32_t index_b) {
+    return time_a < time_b || (time_a == time_b && index_a < index_b);
+}
+
+void HeapQueue::clear(uint32_t now) {
+    for (auto i = (size_t)0; i < capacity_; ++i) {
+        slots_[i].position = HeapNone;
+    }
+    size_ = 0;
+}
+
+bool HeapQueue::push(uint32_t index, uint32_t time) {
+    if (index >= capacity_) {
+        return false;
+    }
+    if (queued(index)) {
+        auto i = slots_[index].position;
+        slots_[i].time = time;
+        sift(i);
+        return true;
+    }
+    set(size_, time, index);
+    sift_up(size_++);
+    return true;
+}
+
+bool HeapQueue::peek(uint32_t &index, uint32_t &time) {
+    if (size_ == 0) {
+        return false;
+    }
+    index = slots_[0].index;
+    time = slots_[0].time;
+    return true;
+}
+
+bool HeapQueue::pop(uint32_t now, uint32_t &index) {
+    if (size_ == 0 || slots_[0].time > now) {
+        return false;
+    }
+    index = slots_[0].index;
+    erase(0);
+    return true;
+}
+
+bool HeapQueue::remove(uint32_t index) {
+    if (!queued(index)) {
+        return false;
+    }
+    erase(slots_[index].position);
+    return true;
+}
+
+bool HeapQueue::move(uint32_t from, uint32_t to) {
+    if (to >= capacity_ || !queued(from) || queued(to)) {
+        return false;
+    }
+    auto i = slots_[from].position;
+    slots_[from].position = HeapNone;
+    set(i, slots_[i].time, to);
+    // Ties are broken by index, so the new one can be out of place.
+    sift(i);
+    return true;
+}
+
+bool HeapQueue::queued(uint32_t index) const {
+    if (index >= capacity_) {
+        return false;
+    }
+    auto i = slots_[index].position;
+    return i < size_ && slots_[i].index == index;
+}
+
+void HeapQueue::set(size_t i, uint32_t time, uint32_t index) {
+    slots_[i].time = time;
+    slots_[i].index = index;
+    slots_[index].position = i;
+}
+
+void HeapQueue::erase(size_t i) {
+    slots_[slots_[i].index].position = HeapNone;
+    if (i != --size_) {
+        set(i, slots_[size_].time, slots_[size_].index);
+        sift(i);
+    }
+}
+
+void HeapQueue::sift(size_t i) {
+    if (i > 0) {
+        auto parent = (i - 1) / 2;
+        if (heap_before(slots_[i].time, slots_[i].index, slots_[parent].time, slots_[parent].index)) {
+            sift_up(i);
+            return;
+        }
+    }
+    sift_down(i);
+}
+
+void HeapQueue::sift_up(size_t i) {
+    auto time = slots_[i].time;
+    auto index = slots_[i].index;
+    while (i > 0) {
+        auto parent = (i - 1) / 2;
+        if (!heap_before(time, index, slots_[parent].time, slots_[parent].index)) {
+            break;
+        }
+        set(i, slots_[parent].time, slots_[parent].index);
+        i = parent;
+    }
+    set(i, time, index);
+}
+
+void HeapQueue::sift_down(size_t i) {
+    if (size_ == 0) {
+        return;
+    }
+    auto time = slots_[i].time;
+    auto index = slots_[i].index;
+    while (true) {
+        auto child = i * 2 + 1;
+        if (child >= size_) {
+            break;
+        }
+        if (child + 1 < size_ && heap_before(slots_[child + 1].time, slots_[child + 1].index, slots_[child].time, slots_[child].index)) {
+            child++;
+        }
+        if (!heap_before(slots_[child].time, slots_[child].index, time, index)) {
+            break;
+        }
+        set(i, slots_[child].time, slots_[child].index);
+        i = child;
+    }
+    set(i, time, index);
+}
+
+static uint32_t clock_micros() {
+#if defined(ARDUINO)
+    return micros();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+#endif
 }
 
 void Scheduler::begin(DateTime now) {
+    for (auto i = (size_t)0; i < size_; i++) {
+        tasks_[i]->slot_ = i;
+    }
+
+    // Only valid and enabled tasks are queued or cached as active.
+    if (active_ != nullptr || queue_ != nullptr) {
+        if (active_ != nullptr) {
+            for (auto i = (size_t)0; i < (capacity_ + 31) / 32; i++) {
+                active_[i] = 0;
+            }
+        }
+        if (queue_ != nullptr) {
+            queue_->clear(now.unix_time());
+        }
+        for (auto i = (size_t)0; i < size_; i++) {
+            schedule(i, now);
+        }
+        return;
+    }
+
     for (auto i = (size_t)0; i < size_; i++) {
         auto task = tasks_[i];
         if (task->valid() && task->enabled()) {
@@ -256,60 +582,390 @@ void Scheduler::begin(DateTime now) {
     }
 }
 
-Scheduler::TaskAndTime Scheduler::check(DateTime now, uint32_t seed) {
+bool Scheduler::add(Task *task, DateTime now) {
+    if (size_ == capacity_) {
+        return false;
+    }
+    tasks_[size_] = task;
+    schedule(size_, now);
+    size_++;
+    return true;
+}
+
+bool Scheduler::remove(Task *task) {
+    uint32_t index;
+    if (!find(task, index)) {
+        return false;
+    }
+
+    auto last = (uint32_t)(size_ - 1);
+    if (queue_ != nullptr) {
+        queue_->remove(index);
+    }
+    if (index != last) {
+        tasks_[index] = tasks_[last];
+        tasks_[index]->slot_ = index;
+        if (queue_ != nullptr) {
+            queue_->move(last, index);
+        }
+        if (active_ != nullptr) {
+            activate(index, bitarray_test(active_[last / 32], last % 32));
+        }
+    }
+    if (active_ != nullptr) {
+        activate(last, false);
+    }
+    tasks_[last] = nullptr;
+    size_--;
+
+    return true;
+}
+
+bool Scheduler::refresh(Task *task, DateTime now) {
+    uint32_t index;
+    if (!find(task, index)) {
+        return false;
+    }
+    schedule(index, now);
+    return true;
+}
+
+bool Scheduler::grow(Task **tasks, size_t capacity, TaskQueue &queue) {
+    if (capacity < size_) {
+        return false;
+    }
+
+    tasks_ = tasks;
+    capacity_ = capacity;
+    queue_ = &queue;
+    active_ = nullptr;
+
+    queue_->clear(last_now_);
+    for (auto i = (size_t)0; i < size_; i++) {
+        auto task = tasks_[i];
+        task->slot_ = i;
+        if (task->valid() && task->enabled()) {
+            queue_->push(i, task->scheduled_);
+        }
+    }
+
+    return true;
+}
+
+bool Scheduler::cache(uint32_t *bits, size_t words) {
+    if (words * 32 < capacity_) {
+        return false;
+    }
+    active_ = bits;
+    for (auto i = (size_t)0; i < (capacity_ + 31) / 32; i++) {
+        active_[i] = 0;
+    }
+    for (auto i = (size_t)0; i < size_; i++) {
+        activate(i, tasks_[i]->valid() && tasks_[i]->enabled());
+    }
+    return true;
+}
+
+bool Scheduler::find(Task *task, uint32_t &index) const {
+    if (task->slot_ < size_ && tasks_[task->slot_] == task) {
+        index = task->slot_;
+        return true;
+    }
+    // Tasks given to the constructor don't know where they are until
+    // begin.
+    for (auto i = (size_t)0; i < size_; i++) {
+        if (tasks_[i] == task) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::schedule(uint32_t index, DateTime now) {
+    auto task = tasks_[index];
+    task->slot_ = index;
+
+    auto active = task->valid() && task->enabled();
+    if (active) {
+        task->scheduled_ = task->getNextTime(now, 0);
+    }
+    if (active_ != nullptr) {
+        activate(index, active);
+    }
+
+    if (queue_ != nullptr) {
+        if (active) {
+            queue_->push(index, task->scheduled_);
+        }
+        else {
+            queue_->remove(index);
+        }
+    }
+}
+
+bool Scheduler::rewound(DateTime now) {
     auto now_unix = now.unix_time();
-    auto difference = (int64_t)now_unix - (int64_t)last_now_;
+    auto previous = last_now_;
+    auto difference = (int64_t)now_unix - (int64_t)previous;
 
     last_now_ = now_unix;
 
     if (difference < 0) {
         if (-difference > RerunThreshold) {
+#if defined(LWCRON_INSTRUMENT)
+            stats_.rebegins++;
+            stats_.rewound_from = previous;
+            stats_.rewound_to = now_unix;
+#endif
+            if (trace_ != nullptr) {
+                trace_->record(TraceType::Rebegin, check_micros_, previous, TraceEvent::NoTask);
+            }
             begin(now);
-            return { };
+            return true;
         }
     }
 
-    for (auto i = (size_t)0; i < size_; i++) {
+    return false;
+}
+
+// Inline, it's in the loop of every scan.
+inline size_t Scheduler::nextActive(size_t from) const {
+    if (active_ != nullptr) {
+        return nextCached(from);
+    }
+    for (auto i = from; i < size_; i++) {
         auto task = tasks_[i];
         if (task->valid() && task->enabled()) {
-            if (task->scheduled_ <= now_unix) {
-                auto scheduled = task->scheduled_;
-                task->scheduled_ = task->getNextTime(now + 1, seed);
-                task->run();
-                return TaskAndTime { scheduled, task };
+            return i;
+        }
+    }
+    return size_;
+}
+
+size_t Scheduler::nextCached(size_t from) const {
+    auto words = (size_ + 31) / 32;
+    auto word = from / 32;
+    if (word >= words) {
+        return size_;
+    }
+    // Bits past size_ are always clear.
+    auto bits = active_[word] & (UINT32_MAX << (from % 32));
+    while (bits == 0) {
+        if (++word == words) {
+            return size_;
+        }
+        bits = active_[word];
+    }
+    return word * 32 + bits_ctz(bits);
+}
+
+void Scheduler::activate(uint32_t index, bool active) {
+    if (active) {
+        bitarray_set(active_[index / 32], index % 32);
+    }
+    else {
+        bitarray_clear(active_[index / 32], index % 32);
+    }
+}
+
+Scheduler::TaskAndTime Scheduler::check(DateTime now, uint32_t seed) {
+    TaskAndTime due;
+    check(now, &due, 1, seed);
+    return due;
+}
+
+size_t Scheduler::check(DateTime now, TaskAndTime *due, size_t size, uint32_t seed, Dispatch dispatch) {
+    if (changes_ != nullptr) {
+        changes_->apply(*this, now);
+    }
+
+#if defined(LWCRON_INSTRUMENT)
+    stats_.checks++;
+#endif
+
+    if (trace_ != nullptr) {
+        check_micros_ = clock_micros();
+        trace_->record(TraceType::Check, check_micros_, now.unix_time(), TraceEvent::NoTask);
+    }
+
+    if (rewound(now)) {
+        return 0;
+    }
+
+    auto now_unix = now.unix_time();
+    auto after = now + 1;
+    auto n = (size_t)0;
+
+    if (queue_ != nullptr) {
+        while (n < size) {
+            auto popped = pop(now, seed);
+            if (!popped) {
+                break;
             }
+            if (dispatch == Dispatch::Run) {
+                run(popped.task);
+            }
+            due[n++] = popped;
         }
+        return n;
+    }
+
+    for (auto i = nextActive(0); i < size_ && n < size; i = nextActive(i + 1)) {
+        auto task = tasks_[i];
+        if (task->scheduled_ <= now_unix) {
+            auto scheduled = task->scheduled_;
+            task->scheduled_ = task->getNextTimeFrom(scheduled, after, seed);
+            fired(task, scheduled, now_unix);
+            if (dispatch == Dispatch::Run) {
+                run(task);
+            }
+            due[n++] = TaskAndTime { scheduled, task };
+        }
+    }
+
+    return n;
+}
+
+Scheduler::TaskAndTime Scheduler::pop(DateTime now, uint32_t seed) {
+    uint32_t index;
+    // With the cache tasks are always refreshed when they change.
+    auto cached = active_ != nullptr;
+    while (queue_->pop(now.unix_time(), index)) {
+        auto task = tasks_[index];
+        // Tasks that have become invalid or disabled since they were
+        // queued are dropped, until they're refreshed or the next begin.
+        if (!cached && !(task->valid() && task->enabled())) {
+            continue;
+        }
+        auto scheduled = task->scheduled_;
+        task->scheduled_ = task->getNextTimeFrom(scheduled, now + 1, seed);
+        queue_->push(index, task->scheduled_);
+        fired(task, scheduled, now.unix_time());
+        return TaskAndTime { scheduled, task };
     }
 
     return { };
 }
 
+#if defined(LWCRON_INSTRUMENT)
+
+constexpr size_t Histogram::Buckets;
+
+void Histogram::record(uint32_t value) {
+    auto bucket = (size_t)0;
+    while (value != 0 && bucket < Buckets - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    counts[bucket]++;
+}
+
+uint32_t Histogram::total() const {
+    auto total = (uint32_t)0;
+    for (auto count : counts) {
+        total += count;
+    }
+    return total;
+}
+
+#endif
+
+void Scheduler::fired(Task *task, uint32_t scheduled, uint32_t now) {
+    if (trace_ != nullptr) {
+        trace_->record(TraceType::Due, check_micros_, scheduled, task->slot_);
+    }
+#if defined(LWCRON_INSTRUMENT)
+    // Only from times check already has, asking the task again would
+    // change what it remembers, like a pooled spec's last answer.
+    auto &stats = task->stats_;
+    auto next = task->scheduled_;
+    stats.lateness.record(now - scheduled);
+    if (next > scheduled) {
+        if (scheduled == now) {
+            stats.spacing = next - scheduled;
+        }
+        else if (stats.spacing > 0) {
+            stats.skipped += (next - scheduled - 1) / stats.spacing;
+        }
+    }
+#endif
+}
+
+void Scheduler::run(Task *task) {
+#if !defined(LWCRON_INSTRUMENT)
+    if (trace_ == nullptr) {
+        task->run();
+        return;
+    }
+#endif
+
+    auto started = clock_micros();
+    if (trace_ != nullptr) {
+        trace_->record(TraceType::RunBegin, started, last_now_, task->slot_);
+    }
+
+    task->run();
+
+    auto finished = clock_micros();
+    if (trace_ != nullptr) {
+        trace_->record(TraceType::RunEnd, finished, last_now_, task->slot_);
+    }
+
+#if defined(LWCRON_INSTRUMENT)
+    auto &stats = task->stats_;
+    auto elapsed = finished - started;
+    stats.duration.record(elapsed);
+    stats.runs++;
+    if (elapsed > OverrunMicros) {
+        stats.overruns++;
+    }
+#endif
+}
+
 Scheduler::TaskAndTime Scheduler::nextTask(DateTime now, uint32_t seed) {
     TaskAndTime found;
-    for (auto i = (size_t)0; i < size_; i++) {
+    for (auto i = nextActive(0); i < size_; i = nextActive(i + 1)) {
         auto task = tasks_[i];
-        if (task->valid() && task->enabled()) {
-            auto time = task->getNextTime(now, seed);
-            if (!found || found.time > time) {
-                found = TaskAndTime { time, task };
-            }
+        auto time = task->getNextTime(now, seed);
+        if (!found || found.time > time) {
+            found = TaskAndTime { time, task };
         }
     }
     return found;
 }
 
 Scheduler::TaskAndTime Scheduler::nextTask() {
+    if (queue_ != nullptr) {
+        uint32_t index;
+        uint32_t time;
+        if (!queue_->peek(index, time)) {
+            return { };
+        }
+        return TaskAndTime { time, tasks_[index] };
+    }
+
     TaskAndTime found;
-    for (auto i = (size_t)0; i < size_; i++) {
+    for (auto i = nextActive(0); i < size_; i = nextActive(i + 1)) {
         auto task = tasks_[i];
-        if (task->valid() && task->enabled()) {
-            auto time = task->scheduled_;
-            if (!found || found.time > time) {
-                found = TaskAndTime { time, task };
-            }
+        auto time = task->scheduled_;
+        if (!found || found.time > time) {
+            found = TaskAndTime { time, task };
         }
     }
     return found;
 }
 
+uint32_t Scheduler::secondsUntilNextTask(DateTime now) {
+    auto next = nextTask();
+    if (!next) {
+        return UINT32_MAX;
+    }
+    auto now_unix = now.unix_time();
+    if (next.time <= now_unix) {
+        return 0;
+    }
+    return next.time - now_unix;
+}
+
 }
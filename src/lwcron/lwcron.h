@@ -7,84 +7,83 @@
 
 namespace lwcron {
 
+constexpr uint32_t SecondsPerDay = 60 * 60 * 24L;
+constexpr uint32_t SecondsPerHour = 3600L;
+
+// The clock going back by more than this many seconds begins the
+// schedule again, less is ignored so tasks aren't run twice.
+constexpr uint32_t RerunThreshold = 30;
+
 struct TimeOfDay {
     int32_t hour;
     int32_t minute;
     int32_t second;
     int32_t remainder;
 
-    TimeOfDay(int32_t hour, int32_t minute, int32_t second) : hour(hour), minute(minute), second(second), remainder(0) {
+    constexpr TimeOfDay(int32_t hour, int32_t minute, int32_t second) : hour(hour), minute(minute), second(second), remainder(0) {
     }
 
-    TimeOfDay(uint32_t t) {
-        second = t % 60;
-        t /= 60;
-        minute = t % 60;
-        t /= 60;
-        hour = t % 24;
-        t /= 24;
-        remainder = t;
+    constexpr TimeOfDay(uint32_t t) : hour((t / 3600) % 24), minute((t / 60) % 60), second(t % 60), remainder(t / SecondsPerDay) {
     }
 };
 
 class DateTime {
 private:
-    uint16_t year_{ 0 };
-    uint8_t month_{ 0 }, day_{ 0 }, hour_{ 0 }, minute_{ 0 }, second_{ 0 };
+    // Only unix time is kept. The calendar fields are worked out from it
+    // when they're read, which is a few multiplies and divides, so a
+    // DateTime is never written by reading it and is safe to share.
+    uint32_t time_{ 0 };
 
 public:
     DateTime() {
     }
 
     DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
-    DateTime(uint32_t time);
 
-public:
-    uint16_t year() const {
-        return year_;
-    }
-    uint8_t month() const {
-        return month_ + 1;
-    }
-    uint8_t day() const {
-        return day_;
+    DateTime(uint32_t time) : time_(time) {
     }
+
+public:
+    uint16_t year() const;
+    uint8_t month() const;
+    uint8_t day() const;
+
     uint8_t hour() const {
-        return hour_;
+        return (time_ / SecondsPerHour) % 24;
     }
     uint8_t minute() const {
-        return minute_;
+        return (time_ / 60) % 60;
     }
     uint8_t second() const {
-        return second_;
+        return time_ % 60;
     }
 
 public:
-    uint32_t unix_time();
+    uint32_t unix_time() const {
+        return time_;
+    }
 
 public:
-    DateTime operator+(const uint32_t seconds) {
-        return DateTime(unix_time() + seconds);
+    DateTime operator+(const uint32_t seconds) const {
+        return DateTime(time_ + seconds);
     }
 
-    DateTime operator-(const uint32_t seconds) {
-        return DateTime(unix_time() - seconds);
+    DateTime operator-(const uint32_t seconds) const {
+        return DateTime(time_ - seconds);
     }
 
     DateTime& operator+=(const uint32_t rhs){
-        *this = DateTime(unix_time() + rhs);
+        time_ += rhs;
         return *this;
     }
 
     DateTime& operator-=(const uint32_t rhs){
-        *this = DateTime(unix_time() - rhs);
+        time_ -= rhs;
         return *this;
     }
 
     bool operator ==(const DateTime &b) const {
-        return year_ == b.year_ && month_ == b.month_ &&
-               day_ == b.day_ && hour_ == b.hour_ &&
-               minute_ == b.minute_ && second_ == b.second_;
+        return time_ == b.time_;
     }
 
     bool operator !=(const DateTime &b) const {
@@ -93,32 +92,139 @@ public:
 
 };
 
+// The first multiple of interval at or after seconds.
+static inline uint32_t periodic_next_time(uint32_t interval, uint32_t seconds) {
+    auto r = seconds % interval;
+    if (r == 0) {
+        return seconds;
+    }
+    return seconds + (interval - r);
+}
+
+// Same, given previous, the last multiple, which is just stepped on from
+// when that's still the answer. Saves a division, which the M0 does in
+// software.
+static inline uint32_t periodic_next_time_from(uint32_t interval, uint32_t previous, uint32_t seconds) {
+    if (previous < seconds && seconds - previous <= interval) {
+        return previous + interval;
+    }
+    return periodic_next_time(interval, seconds);
+}
+
+// Spreads tasks due at the same time out by up to jitter seconds. A seed
+// of zero means no jitter.
+static inline uint32_t jittered(uint32_t time, uint32_t jitter, uint32_t seed) {
+    if (jitter == 0 || seed == 0) {
+        return time;
+    }
+    return time + (seed % jitter);
+}
+
 class Scheduler;
+class Task;
+class TraceBuffer;
 class PeriodicTask;
 class CronTask;
 
+// Building everything with LWCRON_INSTRUMENT defined has Scheduler keep
+// the stats below for every task, which Scheduler::accept hands to the
+// visitor. Without it none of this exists. Tasks change size, so it has
+// to be the same for the whole build.
+#if defined(LWCRON_INSTRUMENT)
+
+// Runs that take longer than this hold up the next tick.
+constexpr uint32_t OverrunMicros = 1000000;
+
+// Counts of values in power of two buckets. Bucket 0 holds zeros, bucket
+// n values from 2^(n-1) up to 2^n - 1 and the last anything bigger.
+struct Histogram {
+    static constexpr size_t Buckets = 24;
+
+    uint32_t counts[Buckets];
+
+    void record(uint32_t value);
+
+    uint32_t total() const;
+
+};
+
+struct TaskStats {
+    // Seconds between when a run was scheduled and the check that ran it.
+    Histogram lateness;
+    // How long run took, in microseconds.
+    Histogram duration;
+    uint32_t runs;
+    uint32_t overruns;
+    // Times the task was due and didn't run because checks came so late
+    // they were passed over. Disabled tasks aren't due. Worked out from
+    // how far the next time is against spacing, so exact for tasks that
+    // are evenly spaced and an estimate for others.
+    uint32_t skipped;
+    // Seconds from the last run that was on time to the one after it.
+    uint32_t spacing;
+};
+
+struct SchedulerStats {
+    uint32_t checks;
+    // Times the clock went back by more than RerunThreshold, beginning
+    // the schedule again, and the last time it did.
+    uint32_t rebegins;
+    uint32_t rewound_from;
+    uint32_t rewound_to;
+};
+
+#endif
+
 class TaskVisitor {
 public:
-    virtual void visit(PeriodicTask &task);
-    virtual void visit(CronTask &task);
+    virtual void visit(PeriodicTask &task) {
+    }
+
+    virtual void visit(CronTask &task) {
+    }
+
+#if defined(LWCRON_INSTRUMENT)
+    virtual void visit(Task &task, TaskStats const &stats) {
+    }
+
+    virtual void visit(Scheduler &scheduler, SchedulerStats const &stats) {
+    }
+#endif
 
 };
 
 class Task {
 private:
     uint32_t scheduled_{ 0 };
+    uint32_t slot_{ 0 };
     bool pending_{ false };
+#if defined(LWCRON_INSTRUMENT)
+    TaskStats stats_{ };
+#endif
 
 public:
     virtual void run() = 0;
     virtual bool valid() const = 0;
     virtual bool enabled() const = 0;
     virtual uint32_t getNextTime(DateTime after, uint32_t seed) const = 0;
+    // Same as getNextTime, given previous, the time the task was last
+    // scheduled for, which has to be before after. Tasks can use that to
+    // step forward rather than working the time out again, subclasses
+    // that change getNextTime need to change this too.
+    virtual uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+        return getNextTime(after, seed);
+    }
     virtual void accept(TaskVisitor &visitor) = 0;
     virtual const char *toString() const {
         return "Task<>";
     }
 
+#if defined(LWCRON_INSTRUMENT)
+    TaskStats const &stats() const {
+        return stats_;
+    }
+#endif
+
 public:
     friend class Scheduler;
 
@@ -129,10 +235,10 @@ private:
     uint32_t interval_{ 0 };
 
 public:
-    PeriodicTask() {
+    constexpr PeriodicTask() {
     }
 
-    PeriodicTask(uint32_t interval) : interval_(interval) {
+    constexpr PeriodicTask(uint32_t interval) : interval_(interval) {
     }
 
 public:
@@ -145,72 +251,124 @@ public:
     bool valid() const override;
     bool enabled() const override;
     uint32_t getNextTime(DateTime after, uint32_t seed) const override;
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const override;
     void accept(TaskVisitor &visitor) override {
         visitor.visit(*this);
     }
 
 };
 
-template<size_t N>
-bool bitarray_any(const uint8_t (&bytes)[N]) {
-    for (auto i = (size_t)0; i < N; ++i) {
-        if (bytes[i] > 0) {
-            return true;
-        }
-    }
-    return false;
+// Cortex-M0 has no count leading/trailing zeros instruction and the
+// builtins there end up as slow library calls, so use table and SWAR
+// versions instead.
+#if defined(__GNUC__) && !defined(__ARM_ARCH_6M__) && !defined(LWCRON_NO_BIT_BUILTINS)
+#define LWCRON_BIT_BUILTINS
+#endif
+
+static inline uint32_t bits_popcount(uint32_t v) {
+#if defined(LWCRON_BIT_BUILTINS)
+    return __builtin_popcount(v);
+#else
+    v = v - ((v >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    return (((v + (v >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+#endif
 }
 
-template<size_t N>
-static inline bool bitarray_test(uint8_t (&p)[N], uint32_t n) {
-    return p[n / 8] & (0x1 << (n % 8));
+static inline uint32_t bits_popcount(uint64_t v) {
+#if defined(LWCRON_BIT_BUILTINS)
+    return __builtin_popcountll(v);
+#else
+    return bits_popcount((uint32_t)v) + bits_popcount((uint32_t)(v >> 32));
+#endif
 }
 
-template<size_t N>
-uint32_t bitarray_nset(uint8_t (&bytes)[N]) {
-    auto c = 0u;
-    for (auto i = 0u; i < N * 8u; ++i) {
-        if (bitarray_test(bytes, i)) {
-            c++;
-        }
+// Undefined for zero.
+static inline uint32_t bits_ctz(uint32_t v) {
+#if defined(LWCRON_BIT_BUILTINS)
+    return __builtin_ctz(v);
+#else
+    static const uint8_t DeBruijn[32] = {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    return DeBruijn[((v & -v) * 0x077cb531u) >> 27];
+#endif
+}
+
+static inline uint32_t bits_ctz(uint64_t v) {
+#if defined(LWCRON_BIT_BUILTINS)
+    return __builtin_ctzll(v);
+#else
+    auto low = (uint32_t)v;
+    return low != 0 ? bits_ctz(low) : 32 + bits_ctz((uint32_t)(v >> 32));
+#endif
+}
+
+template<typename T>
+static inline bool bitarray_any(T word) {
+    return word != 0;
+}
+
+template<typename T>
+static inline bool bitarray_test(T word, uint32_t n) {
+    return (word >> n) & 0x1;
+}
+
+template<typename T>
+static inline uint32_t bitarray_nset(T word) {
+    return bits_popcount(word);
+}
+
+// Index of the first set bit at or after n and below limit, or -1.
+template<typename T>
+static inline int32_t bitarray_next(T word, uint32_t n, uint32_t limit = sizeof(T) * 8) {
+    if (n >= limit) {
+        return -1;
+    }
+    word &= ~(T)0 << n;
+    if (word == 0) {
+        return -1;
     }
-    return c;
+    auto found = bits_ctz(word);
+    return found < limit ? (int32_t)found : -1;
 }
 
-template<size_t N>
-static inline void bitarray_clear_set(uint8_t (&p)[N], uint32_t n) {
-    bzero(&p, sizeof(p));
-    p[n / 8] |= (0x1 << (n % 8));
+template<typename T>
+static inline void bitarray_clear_set(T &word, uint32_t n) {
+    word = (T)1 << n;
 }
 
-template<size_t N>
-static inline void bitarray_set(uint8_t (&p)[N], uint32_t n) {
-    p[n / 8] |= (0x1 << (n % 8));
+template<typename T>
+static inline void bitarray_set(T &word, uint32_t n) {
+    word |= (T)1 << n;
 }
 
-template<size_t N>
-static inline void bitarray_clear(uint8_t (&p)[N], uint32_t n) {
-    p[n / 8] &= ~(0x1 << (n % 8));
+template<typename T>
+static inline void bitarray_clear(T &word, uint32_t n) {
+    word &= ~((T)1 << n);
 }
 
 struct CronSpec {
 public:
-    uint8_t seconds[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t minutes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t hours[3] = { 0, 0, 0 };
+    static constexpr uint64_t AllSeconds = (1ull << 60) - 1;
+    static constexpr uint64_t AllMinutes = (1ull << 60) - 1;
+    static constexpr uint32_t AllHours = (1u << 24) - 1;
 
 public:
-    CronSpec() {
+    uint64_t seconds{ 0 };
+    uint64_t minutes{ 0 };
+    uint32_t hours{ 0 };
+
+public:
+    constexpr CronSpec() {
     }
 
-    CronSpec(TimeOfDay tod) {
-        set(tod);
+    constexpr CronSpec(TimeOfDay tod) : CronSpec(tod.hour, tod.minute, tod.second) {
     }
 
-    CronSpec(int32_t hours, int32_t minutes, int32_t seconds) {
-        bitarray_set(this->hours, hours);
-        bitarray_set(this->minutes, minutes);
-        bitarray_set(this->seconds, seconds);
+    constexpr CronSpec(int32_t hours, int32_t minutes, int32_t seconds) :
+        seconds((uint64_t)1 << seconds), minutes((uint64_t)1 << minutes), hours((uint32_t)1 << hours) {
     }
 
     CronSpec(DateTime const &when) {
@@ -228,64 +386,111 @@ public:
 
     uint32_t getNextTime(DateTime after) const;
 
-    static CronSpec interval(uint32_t seconds);
+    // The first time after previous, which has to match, that's in the
+    // same day, or zero.
+    uint32_t getFollowingTime(uint32_t previous) const;
 
-    static CronSpec specific(uint8_t second, uint8_t minute = 0xff, uint8_t hour = 0xff);
+    // Slow forward walk, kept to check getNextTime against.
+    uint32_t getNextTimeReference(DateTime after) const;
+
+    static constexpr CronSpec bits(uint64_t seconds, uint64_t minutes, uint32_t hours) {
+        return CronSpec{ seconds, minutes, hours, Bits{ } };
+    }
 
-    static CronSpec everyFiveMinutes();
+    // Matches every time of day that's a multiple of seconds since
+    // midnight. Each field only depends on the steps until its pattern
+    // repeats, and those are split in halves so the recursion stays
+    // shallow enough to be evaluated at compile time.
+    static constexpr CronSpec interval(uint32_t seconds) {
+        return seconds == 0 ? CronSpec{ } : bits(
+            interval_bits(seconds, 0, steps(seconds, 60), 1, 60),
+            seconds <= 60 ? AllMinutes : interval_bits(seconds, 0, steps(seconds, 3600), 60, 60),
+            seconds <= 3600 ? AllHours : (uint32_t)interval_bits(seconds, 0, steps(seconds, SecondsPerDay), 3600, 24));
+    }
+
+    static constexpr CronSpec specific(uint8_t second, uint8_t minute = 0xff, uint8_t hour = 0xff) {
+        return bits((uint64_t)1 << second,
+                    minute == 0xff ? AllMinutes : (uint64_t)1 << minute,
+                    hour == 0xff ? AllHours : (uint32_t)1 << hour);
+    }
 
-    static CronSpec everyTwentyMinutes();
+    // Parses a "seconds minutes hours" expression like "*/5 0-30 9-17".
+    // Each field is a comma separated list of *, a number, or a range
+    // a-b, any of them optionally followed by /step. a/step runs from a
+    // to the end of the field. Leaves spec alone and returns false if
+    // the expression is malformed. See expression.h for string literals.
+    static bool parse(const char *expression, CronSpec &spec);
 
-    inline bool operator==(CronSpec const &rhs) const {
-        return memcmp(hours, rhs.hours, sizeof(hours)) == 0 &&
-               memcmp(minutes, rhs.minutes, sizeof(minutes)) == 0 &&
-               memcmp(seconds, rhs.seconds, sizeof(seconds)) == 0;
+    static constexpr CronSpec everyFiveMinutes() {
+        return bits(1, every(5, 60), AllHours);
     }
 
-    inline bool operator!=(CronSpec const &rhs) const {
+    static constexpr CronSpec everyTwentyMinutes() {
+        return bits(1, every(20, 60), AllHours);
+    }
+
+    constexpr bool operator==(CronSpec const &rhs) const {
+        return hours == rhs.hours && minutes == rhs.minutes && seconds == rhs.seconds;
+    }
+
+    constexpr bool operator!=(CronSpec const &rhs) const {
         return !(*this == rhs);
     }
 
 private:
+    struct Bits {
+    };
+
+    constexpr CronSpec(uint64_t seconds, uint64_t minutes, uint32_t hours, Bits) : seconds(seconds), minutes(minutes), hours(hours) {
+    }
+
+    static constexpr uint64_t every(uint32_t step, uint32_t limit, uint32_t from = 0) {
+        return from >= limit ? 0 : ((uint64_t)1 << from) | every(step, limit, from + step);
+    }
+
+    static constexpr uint32_t steps(uint32_t seconds, uint32_t period) {
+        return SecondsPerDay / seconds + 1 < period ? SecondsPerDay / seconds + 1 : period;
+    }
+
+    static constexpr uint64_t interval_bits(uint32_t step, uint32_t from, uint32_t to, uint32_t unit, uint32_t modulo) {
+        return to - from == 1 ? (uint64_t)1 << ((from * step / unit) % modulo) :
+               interval_bits(step, from, from + (to - from) / 2, unit, modulo) |
+               interval_bits(step, from + (to - from) / 2, to, unit, modulo);
+    }
+
     bool matches(CronSpec const &cs) const {
         return matches_hours(cs) && matches_minutes(cs) && matches_seconds(cs);
     }
 
     bool matches_hours(CronSpec const &cs) const {
-        return matches(hours, cs.hours, sizeof(hours));
+        return (hours & cs.hours) != 0;
     }
 
     bool matches_minutes(CronSpec const &cs) const {
-        return matches(minutes, cs.minutes, sizeof(minutes));
+        return (minutes & cs.minutes) != 0;
     }
 
     bool matches_seconds(CronSpec const &cs) const {
-        return matches(seconds, cs.seconds, sizeof(seconds));
-    }
-
-    static bool matches(uint8_t const *a, uint8_t const *b, size_t size) {
-        for (auto i = 0u; i < size; ++i) {
-            if ((a[i] & b[i]) > 0) {
-                return true;
-            }
-        }
-        return false;
+        return (seconds & cs.seconds) != 0;
     }
 };
 
+// CronTask::getNextTimeFrom for any task with a spec and jitter.
+uint32_t cron_next_time_from(CronSpec const &spec, uint32_t jitter, uint32_t previous, DateTime after, uint32_t seed);
+
 class CronTask : public Task {
 private:
     CronSpec spec_;
     uint32_t jitter_;
 
 public:
-    CronTask() : jitter_(0) {
+    constexpr CronTask() : jitter_(0) {
     }
 
-    CronTask(CronSpec spec) : spec_(spec), jitter_(0) {
+    constexpr CronTask(CronSpec spec) : spec_(spec), jitter_(0) {
     }
 
-    CronTask(CronSpec spec, uint32_t jitter) : spec_(spec), jitter_(jitter) {
+    constexpr CronTask(CronSpec spec, uint32_t jitter) : spec_(spec), jitter_(jitter) {
     }
 
 public:
@@ -293,29 +498,203 @@ public:
         return spec_;
     }
 
+    uint32_t jitter() const {
+        return jitter_;
+    }
+
 public:
     void run() override;
     bool valid() const override;
     bool enabled() const override;
     uint32_t getNextTime(DateTime after, uint32_t seed) const override;
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const override;
     void accept(TaskVisitor &visitor) override {
         visitor.visit(*this);
     }
 
 };
 
+// Interns identical CronSpecs so the tasks using them share one entry,
+// which remembers the last time it worked out. Everything due in the
+// same tick asks with the same after, so each distinct spec is only
+// worked out once a tick however many tasks use it. Not thread safe,
+// share one between the tasks of a single Scheduler.
+class CronSpecPool {
+public:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Entry {
+        CronSpec spec;
+        uint32_t after;
+        uint32_t next;
+    };
+
+private:
+    Entry *entries_{ nullptr };
+    size_t capacity_{ 0 };
+    size_t size_{ 0 };
+    uint32_t misses_{ 0 };
+
+public:
+    CronSpecPool(Entry *entries, size_t capacity) : entries_(entries), capacity_(capacity) {
+    }
+
+    template<size_t N>
+    CronSpecPool(Entry (&entries)[N]) : entries_(&entries[0]), capacity_(N) {
+    }
+
+public:
+    size_t size() const {
+        return size_;
+    }
+
+    // How many times a spec's next time had to be worked out.
+    uint32_t misses() const {
+        return misses_;
+    }
+
+    CronSpec const &spec(uint32_t index) const {
+        return entries_[index].spec;
+    }
+
+public:
+    // The spec's index, or None when it's new and there's no room.
+    uint32_t intern(CronSpec spec);
+
+    uint32_t getNextTime(uint32_t index, DateTime after);
+
+};
+
+// A CronTask whose spec lives in a CronSpecPool, falls back to working
+// its times out alone when the pool was full.
+class PooledCronTask : public CronTask {
+private:
+    CronSpecPool *pool_;
+    uint32_t entry_;
+
+public:
+    PooledCronTask(CronSpecPool &pool, CronSpec spec, uint32_t jitter = 0) : CronTask(spec, jitter), pool_(&pool), entry_(pool.intern(spec)) {
+    }
+
+public:
+    uint32_t getNextTime(DateTime after, uint32_t seed) const override;
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const override;
+
+};
+
+// Orders a Scheduler's tasks by their next scheduled time. Entries are
+// indices into the Scheduler's task array. Without one the Scheduler
+// scans every task.
+class TaskQueue {
+public:
+    virtual void clear(uint32_t now) = 0;
+    // Pushing an index that's already queued moves it to the new time.
+    virtual bool push(uint32_t index, uint32_t time) = 0;
+    // Earliest entry, ties go to the lowest index.
+    virtual bool peek(uint32_t &index, uint32_t &time) = 0;
+    // Removes an entry whose time is at or before now.
+    virtual bool pop(uint32_t now, uint32_t &index) = 0;
+    virtual bool remove(uint32_t index) = 0;
+    // Renames a queued index, from must be queued and to must not be.
+    virtual bool move(uint32_t from, uint32_t to) = 0;
+
+};
+
+class HeapQueue : public TaskQueue {
+public:
+    // The first size() slots are the heap, ordered by time and index.
+    // Separately, position in the slot for an index is where that index
+    // is in the heap, so indices have to be below the capacity.
+    struct Slot {
+        uint32_t time;
+        uint32_t index;
+        uint32_t position;
+    };
+
+private:
+    Slot *slots_{ nullptr };
+    size_t capacity_{ 0 };
+    size_t size_{ 0 };
+
+public:
+    HeapQueue(Slot *slots, size_t capacity) : slots_(slots), capacity_(capacity) {
+        clear(0);
+    }
+
+    template<size_t N>
+    HeapQueue(Slot (&slots)[N]) : HeapQueue(&slots[0], N) {
+    }
+
+public:
+    size_t size() const {
+        return size_;
+    }
+
+public:
+    void clear(uint32_t now) override;
+    bool push(uint32_t index, uint32_t time) override;
+    bool peek(uint32_t &index, uint32_t &time) override;
+    bool pop(uint32_t now, uint32_t &index) override;
+    bool remove(uint32_t index) override;
+    bool move(uint32_t from, uint32_t to) override;
+
+private:
+    bool queued(uint32_t index) const;
+    void set(size_t i, uint32_t time, uint32_t index);
+    void erase(size_t i);
+    void sift(size_t i);
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+
+};
+
+// Changes to a Scheduler's tasks made from other threads, applied by
+// check before it does anything else.
+class TaskChanges {
+public:
+    virtual void apply(Scheduler &scheduler, DateTime now) = 0;
+
+};
+
 class Scheduler {
 private:
     Task **tasks_{ nullptr };
     size_t size_{ 0 };
+    size_t capacity_{ 0 };
     uint32_t last_now_{ 0 };
+    TaskQueue *queue_{ nullptr };
+    TaskChanges *changes_{ nullptr };
+    uint32_t *active_{ nullptr };
+    TraceBuffer *trace_{ nullptr };
+    uint32_t check_micros_{ 0 };
+#if defined(LWCRON_INSTRUMENT)
+    SchedulerStats stats_{ };
+#endif
 
 public:
     Scheduler() {
     }
 
     template<size_t N>
-    Scheduler(Task* (&tasks)[N]) : tasks_(&tasks[0]), size_(N) {
+    Scheduler(Task* (&tasks)[N]) : tasks_(&tasks[0]), size_(N), capacity_(N) {
+    }
+
+    template<size_t N>
+    Scheduler(Task* (&tasks)[N], TaskQueue &queue) : tasks_(&tasks[0]), size_(N), capacity_(N), queue_(&queue) {
+    }
+
+    Scheduler(Task **tasks, size_t size) : tasks_(tasks), size_(size), capacity_(size) {
+    }
+
+    Scheduler(Task **tasks, size_t size, TaskQueue &queue) : tasks_(tasks), size_(size), capacity_(size), queue_(&queue) {
+    }
+
+    // The first size of tasks are in use, the rest up to capacity are
+    // free for add. A queue needs the same capacity.
+    Scheduler(Task **tasks, size_t size, size_t capacity) : tasks_(tasks), size_(size), capacity_(capacity) {
+    }
+
+    Scheduler(Task **tasks, size_t size, size_t capacity, TaskQueue &queue) : tasks_(tasks), size_(size), capacity_(capacity), queue_(&queue) {
     }
 
 public:
@@ -323,6 +702,10 @@ public:
         return size_;
     }
 
+    size_t capacity() const {
+        return capacity_;
+    }
+
     Task *get(size_t i) const {
         return tasks_[i];
     }
@@ -335,9 +718,21 @@ public:
     void accept(TaskVisitor &visitor) {
         for (size_t i = 0; i < size_; ++i) {
             tasks_[i]->accept(visitor);
+#if defined(LWCRON_INSTRUMENT)
+            visitor.visit(*tasks_[i], tasks_[i]->stats_);
+#endif
         }
+#if defined(LWCRON_INSTRUMENT)
+        visitor.visit(*this, stats_);
+#endif
     }
 
+#if defined(LWCRON_INSTRUMENT)
+    SchedulerStats const &stats() const {
+        return stats_;
+    }
+#endif
+
 public:
     struct TaskAndTime {
         uint32_t time{ 0 };
@@ -354,13 +749,96 @@ public:
         }
     };
 
+    enum class Dispatch {
+        Run,
+        Collect,
+    };
+
     void begin(DateTime now);
 
+    // Adding, removing and refreshing only schedule the one task, in O(1)
+    // without a queue or O(log n) with a HeapQueue. Removing moves the
+    // last task into the removed task's place.
+    bool add(Task *task, DateTime now);
+
+    bool remove(Task *task);
+
+    // Call after a task is enabled, disabled or otherwise changed when.
+    bool refresh(Task *task, DateTime now);
+
+    // Moves to larger storage, which has to start with the same tasks,
+    // and queues every task for the time it's already scheduled for
+    // instead of beginning again. Any cache is dropped, give it again.
+    bool grow(Task **tasks, size_t capacity, TaskQueue &queue);
+
+    void changes(TaskChanges &changes) {
+        changes_ = &changes;
+    }
+
+    // Keeps whether each task is valid and enabled in bits, one per task
+    // up to the capacity, so check and nextTask skip inactive tasks with a
+    // bit scan instead of asking every task. Tasks then have to be
+    // refreshed whenever either changes. The bits are filled in from the
+    // tasks straight away.
+    bool cache(uint32_t *bits, size_t words);
+
+    template<size_t N>
+    bool cache(uint32_t (&bits)[N]) {
+        return cache(&bits[0], N);
+    }
+
+    // Records each check, the tasks it finds due, their runs and the
+    // schedule beginning again into trace, see trace.h.
+    void trace(TraceBuffer &trace) {
+        trace_ = &trace;
+    }
+
     TaskAndTime check(DateTime now, uint32_t seed = 0);
 
+    // Reschedules every task that's due, in the order repeated calls to
+    // check would, and fills due with them. Collect leaves running them to
+    // the caller. Returns how many were filled in, anything that doesn't
+    // fit stays due.
+    size_t check(DateTime now, TaskAndTime *due, size_t size, uint32_t seed = 0, Dispatch dispatch = Dispatch::Run);
+
+    template<size_t N>
+    size_t check(DateTime now, TaskAndTime (&due)[N], uint32_t seed = 0, Dispatch dispatch = Dispatch::Run) {
+        return check(now, &due[0], N, seed, dispatch);
+    }
+
     TaskAndTime nextTask(DateTime now, uint32_t seed = 0);
 
     TaskAndTime nextTask();
+
+    // Seconds until the next task is due, zero if one already is, or
+    // UINT32_MAX if there's nothing scheduled. Callers can sleep this
+    // long instead of polling check every second. With a queue this is
+    // O(1) or close to it. A task that's disabled without being refreshed
+    // can still cause one early wakeup, check drops it from the queue.
+    uint32_t secondsUntilNextTask(DateTime now);
+
+private:
+    bool rewound(DateTime now);
+
+    bool find(Task *task, uint32_t &index) const;
+
+    void schedule(uint32_t index, DateTime now);
+
+    TaskAndTime pop(DateTime now, uint32_t seed);
+
+    // First valid and enabled task at or after from, or size_.
+    size_t nextActive(size_t from) const;
+
+    size_t nextCached(size_t from) const;
+
+    void activate(uint32_t index, bool active);
+
+    // Due task bookkeeping, which only does anything when instrumented.
+    // Call once the task's been rescheduled.
+    void fired(Task *task, uint32_t scheduled, uint32_t now);
+
+    void run(Task *task);
+
 };
 
 }
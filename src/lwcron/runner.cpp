@@ -0,0 +1,156 @@
+#if defined(__linux__)
+
+#include <cerrno>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "runner.h"
+
+namespace lwcron {
+
+constexpr size_t DispatchBatchSize = 16;
+
+// time() may read a coarse clock that lags the timerfd by a tick.
+static DateTime wall_clock() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return DateTime{ (uint32_t)ts.tv_sec };
+}
+
+bool LinuxRunner::open() {
+    close();
+
+    stopping_ = false;
+    armed_ = 0;
+
+    epoll_ = epoll_create1(EPOLL_CLOEXEC);
+    timer_ = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    event_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_ < 0 || timer_ < 0 || event_ < 0) {
+        close();
+        return false;
+    }
+
+    epoll_event ev = { };
+    ev.events = EPOLLIN;
+    ev.data.fd = timer_;
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, timer_, &ev) < 0) {
+        close();
+        return false;
+    }
+    ev.data.fd = event_;
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, event_, &ev) < 0) {
+        close();
+        return false;
+    }
+
+    scheduler_->begin(wall_clock());
+
+    return true;
+}
+
+void LinuxRunner::close() {
+    int *fds[] = { &epoll_, &timer_, &event_ };
+    for (auto fd : fds) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+bool LinuxRunner::poll(int32_t timeout_ms) {
+    if (epoll_ < 0 || stopping_) {
+        return false;
+    }
+
+    if (!dispatch() || !arm()) {
+        return false;
+    }
+
+    epoll_event events[2];
+    auto n = epoll_wait(epoll_, events, 2, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR;
+    }
+
+    for (auto i = 0; i < n; ++i) {
+        uint64_t value;
+        if (events[i].data.fd == timer_) {
+            if (read(timer_, &value, sizeof(value)) < 0 && errno == ECANCELED) {
+                // The clock was set, everything needs working out again.
+                scheduler_->begin(wall_clock());
+            }
+            // Expired or cancelled, either way the timer is now disarmed.
+            armed_ = 0;
+        }
+        else if (events[i].data.fd == event_) {
+            if (read(event_, &value, sizeof(value)) == sizeof(value)) {
+                armed_ = 0;
+            }
+        }
+    }
+
+    if (stopping_) {
+        return false;
+    }
+
+    return dispatch();
+}
+
+void LinuxRunner::run() {
+    while (poll()) {
+    }
+}
+
+void LinuxRunner::stop() {
+    stopping_ = true;
+    wake();
+}
+
+void LinuxRunner::wake() {
+    uint64_t value = 1;
+    if (event_ >= 0) {
+        auto written = write(event_, &value, sizeof(value));
+        (void)written;
+    }
+}
+
+bool LinuxRunner::dispatch() {
+    while (true) {
+        auto now = wall_clock();
+        Scheduler::TaskAndTime due[DispatchBatchSize];
+        auto n = scheduler_->check(now, due, now.unix_time());
+        if (n < DispatchBatchSize) {
+            return true;
+        }
+    }
+}
+
+bool LinuxRunner::arm() {
+    auto next = scheduler_->nextTask();
+
+    // With nothing to do the timer is still armed, far in the future, so
+    // that a change to the clock wakes us.
+    auto time = next ? next.time : UINT32_MAX;
+    if (time == armed_) {
+        return true;
+    }
+
+    itimerspec spec = { };
+    spec.it_value.tv_sec = time;
+    if (timerfd_settime(timer_, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) < 0) {
+        return false;
+    }
+
+    armed_ = time;
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LWCRON_RUNNER_H_INCLUDED
+#define LWCRON_RUNNER_H_INCLUDED
+
+#if defined(__linux__)
+
+#include <atomic>
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Runs a Scheduler against the wall clock on Linux. Between tasks it
+// blocks in epoll_wait on a timerfd armed for the next scheduled time,
+// rather than polling once a second. The timer is armed with
+// TFD_TIMER_CANCEL_ON_SET so that the clock being set wakes it up, and
+// the scheduler is begun again.
+class LinuxRunner {
+private:
+    Scheduler *scheduler_;
+    int epoll_{ -1 };
+    int timer_{ -1 };
+    int event_{ -1 };
+    std::atomic<bool> stopping_{ false };
+    uint32_t armed_{ 0 };
+
+public:
+    LinuxRunner(Scheduler &scheduler) : scheduler_(&scheduler) {
+    }
+
+    ~LinuxRunner() {
+        close();
+    }
+
+public:
+    bool open();
+
+    void close();
+
+    // Runs due tasks and waits for the next one, or timeout_ms. Returns
+    // false once stopped or if something went wrong.
+    bool poll(int32_t timeout_ms = -1);
+
+    // Calls poll until stopped.
+    void run();
+
+    // Safe to call from other threads, or from a task.
+    void stop();
+
+    // Re-arms the timer, call after changing the scheduler's tasks.
+    // Safe to call from other threads.
+    void wake();
+
+private:
+    bool dispatch();
+    bool arm();
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+#if !defined(ARDUINO)
+
+#include "sharded.h"
+
+namespace lwcron {
+
+constexpr size_t ShardBatchSize = 16;
+constexpr size_t ShardInitialCapacity = 16;
+
+ShardedScheduler::ShardedScheduler(size_t shards) {
+    for (auto i = (size_t)0; i < (shards == 0 ? 1 : shards); ++i) {
+        shards_.emplace_back(new Shard());
+    }
+}
+
+size_t ShardedScheduler::shard(Task *task) const {
+    // Fibonacci hashing, the low bits of a pointer are mostly alignment.
+    auto hash = (uint64_t)(uintptr_t)task * 0x9e3779b97f4a7c15ull;
+    return (size_t)((hash >> 32) % shards_.size());
+}
+
+void ShardedScheduler::add(Task *task, DateTime now) {
+    auto &shard = *shards_[this->shard(task)];
+    std::lock_guard<std::mutex> guard{ shard.lock };
+
+    // Growing requeues everything else at the times they already have,
+    // beginning again would run the ones due at now a second time.
+    auto size = shard.scheduler.size();
+    if (size == shard.scheduler.capacity()) {
+        auto capacity = size == 0 ? ShardInitialCapacity : size * 2;
+        shard.tasks.resize(capacity);
+        shard.slots.resize(capacity);
+        shard.queue = HeapQueue{ shard.slots.data(), capacity };
+        shard.scheduler.grow(shard.tasks.data(), capacity, shard.queue);
+    }
+
+    shard.scheduler.add(task, now);
+    shard.size = shard.scheduler.size();
+
+    if (shard.begun) {
+        publish(shard);
+    }
+}
+
+void ShardedScheduler::begin(DateTime now) {
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> guard{ shard->lock };
+        shard->now = now.unix_time();
+        shard->begun = true;
+        shard->scheduler.begin(now);
+        publish(*shard);
+    }
+}
+
+size_t ShardedScheduler::check(size_t index, DateTime now, uint32_t seed) {
+    auto &shard = *shards_[index];
+    auto ran = (size_t)0;
+
+    while (true) {
+        Scheduler::TaskAndTime due[ShardBatchSize];
+        size_t n;
+        {
+            std::lock_guard<std::mutex> guard{ shard.lock };
+            shard.now = now.unix_time();
+            n = shard.scheduler.check(now, due, seed, Scheduler::Dispatch::Collect);
+            publish(shard);
+        }
+
+        for (auto i = (size_t)0; i < n; ++i) {
+            due[i].task->run();
+        }
+
+        ran += n;
+
+        if (n < ShardBatchSize) {
+            break;
+        }
+    }
+
+    shard.runs += ran;
+
+    return ran;
+}
+
+uint32_t ShardedScheduler::nextTime() const {
+    auto earliest = UINT32_MAX;
+    for (auto &shard : shards_) {
+        auto time = shard->next.load(std::memory_order_relaxed);
+        if (time < earliest) {
+            earliest = time;
+        }
+    }
+    return earliest;
+}
+
+uint32_t ShardedScheduler::nextTime(size_t shard) const {
+    return shards_[shard]->next.load(std::memory_order_relaxed);
+}
+
+ShardedScheduler::Stats ShardedScheduler::stats() const {
+    Stats stats{ 0, 0 };
+    for (auto i = (size_t)0; i < shards_.size(); ++i) {
+        auto shard = this->stats(i);
+        stats.tasks += shard.tasks;
+        stats.runs += shard.runs;
+    }
+    return stats;
+}
+
+ShardedScheduler::Stats ShardedScheduler::stats(size_t shard) const {
+    return Stats{ shards_[shard]->size.load(), shards_[shard]->runs.load() };
+}
+
+void ShardedScheduler::publish(Shard &shard) {
+    auto next = shard.scheduler.nextTask();
+    shard.next.store(next ? next.time : UINT32_MAX, std::memory_order_relaxed);
+}
+
+}
+
+#endif
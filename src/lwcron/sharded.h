@@ -0,0 +1,86 @@
+#ifndef LWCRON_SHARDED_H_INCLUDED
+#define LWCRON_SHARDED_H_INCLUDED
+
+// Needs threads, so hosted builds only.
+#if !defined(ARDUINO)
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Spreads tasks over a number of shards, by hashing the task, each with
+// its own Scheduler and HeapQueue. Each shard is meant to be checked by
+// its own thread, checks of different shards don't contend with each
+// other. Every shard publishes its earliest time, nextTime reads those
+// without taking any locks.
+class ShardedScheduler {
+public:
+    struct Stats {
+        uint64_t tasks;
+        uint64_t runs;
+    };
+
+private:
+    struct Shard {
+        std::mutex lock;
+        std::vector<Task*> tasks;
+        std::vector<HeapQueue::Slot> slots;
+        HeapQueue queue{ nullptr, 0 };
+        Scheduler scheduler;
+        uint32_t now{ 0 };
+        bool begun{ false };
+        std::atomic<uint32_t> next{ UINT32_MAX };
+        std::atomic<uint64_t> size{ 0 };
+        std::atomic<uint64_t> runs{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+public:
+    ShardedScheduler(size_t shards);
+
+public:
+    size_t shards() const {
+        return shards_.size();
+    }
+
+    // The shard a task belongs to.
+    size_t shard(Task *task) const;
+
+public:
+    // Safe to call while other threads are checking. Only the task's
+    // shard is locked, and only the task is scheduled, from now.
+    void add(Task *task, DateTime now);
+
+    void begin(DateTime now);
+
+    // Runs every due task in one shard, returning how many ran. Tasks are
+    // run with the shard unlocked so adding to it never waits on them.
+    size_t check(size_t shard, DateTime now, uint32_t seed = 0);
+
+    // Earliest scheduled time across all shards, or UINT32_MAX when
+    // there's nothing scheduled.
+    uint32_t nextTime() const;
+
+    // Earliest scheduled time for one shard.
+    uint32_t nextTime(size_t shard) const;
+
+    Stats stats() const;
+
+    Stats stats(size_t shard) const;
+
+private:
+    void publish(Shard &shard);
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef LWCRON_STATIC_H_INCLUDED
+#define LWCRON_STATIC_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Tasks for StaticScheduler, which calls these on the concrete type, so
+// there are no virtual functions and no vtables. Derive and define run,
+// and enabled if needed, to hide these ones.
+class StaticPeriodicTask {
+private:
+    uint32_t interval_{ 0 };
+
+public:
+    constexpr StaticPeriodicTask() {
+    }
+
+    constexpr StaticPeriodicTask(uint32_t interval) : interval_(interval) {
+    }
+
+public:
+    uint32_t interval() const {
+        return interval_;
+    }
+
+public:
+    void run() {
+    }
+
+    bool valid() const {
+        return interval_ > 0;
+    }
+
+    bool enabled() const {
+        return true;
+    }
+
+    uint32_t getNextTime(DateTime after, uint32_t seed) const {
+        return periodic_next_time(interval_, after.unix_time());
+    }
+
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+        return periodic_next_time_from(interval_, previous, after.unix_time());
+    }
+
+};
+
+class StaticCronTask {
+private:
+    CronSpec spec_;
+    uint32_t jitter_;
+
+public:
+    constexpr StaticCronTask() : jitter_(0) {
+    }
+
+    constexpr StaticCronTask(CronSpec spec) : spec_(spec), jitter_(0) {
+    }
+
+    constexpr StaticCronTask(CronSpec spec, uint32_t jitter) : spec_(spec), jitter_(jitter) {
+    }
+
+public:
+    CronSpec spec() const {
+        return spec_;
+    }
+
+    uint32_t jitter() const {
+        return jitter_;
+    }
+
+public:
+    void run() {
+    }
+
+    bool valid() const {
+        return spec_.valid();
+    }
+
+    bool enabled() const {
+        return true;
+    }
+
+    uint32_t getNextTime(DateTime after, uint32_t seed) const {
+        return jittered(spec_.getNextTime(after), jitter_, seed);
+    }
+
+    uint32_t getNextTimeFrom(uint32_t previous, DateTime after, uint32_t seed) const {
+        return cron_next_time_from(spec_, jitter_, previous, after, seed);
+    }
+
+};
+
+// Each task stored by value next to its scheduled time, one after the
+// other. Every operation recurses through the types, which the compiler
+// unrolls into straight line code.
+template<typename... Tasks>
+struct StaticTasks {
+    void begin(DateTime now) {
+    }
+
+    size_t check(uint32_t now, DateTime after, uint32_t seed) {
+        return 0;
+    }
+
+    uint32_t nextTime(uint32_t found) const {
+        return found;
+    }
+};
+
+template<typename T, typename... Rest>
+struct StaticTasks<T, Rest...> {
+    T task;
+    uint32_t scheduled{ 0 };
+    StaticTasks<Rest...> rest;
+
+    StaticTasks(T first, Rest... others) : task(first), rest(others...) {
+    }
+
+    void begin(DateTime now) {
+        if (task.valid() && task.enabled()) {
+            scheduled = task.getNextTime(now, 0);
+        }
+        rest.begin(now);
+    }
+
+    size_t check(uint32_t now, DateTime after, uint32_t seed) {
+        auto n = (size_t)0;
+        if (task.valid() && task.enabled()) {
+            if (scheduled <= now) {
+                scheduled = task.getNextTimeFrom(scheduled, after, seed);
+                task.run();
+                n++;
+            }
+        }
+        return n + rest.check(now, after, seed);
+    }
+
+    uint32_t nextTime(uint32_t found) const {
+        if (task.valid() && task.enabled()) {
+            if (found == 0 || scheduled < found) {
+                found = scheduled;
+            }
+        }
+        return rest.nextTime(found);
+    }
+};
+
+template<size_t I, typename Tasks>
+struct StaticTaskAt;
+
+template<typename T, typename... Rest>
+struct StaticTaskAt<0, StaticTasks<T, Rest...>> {
+    using type = T;
+
+    static T &get(StaticTasks<T, Rest...> &tasks) {
+        return tasks.task;
+    }
+};
+
+template<size_t I, typename T, typename... Rest>
+struct StaticTaskAt<I, StaticTasks<T, Rest...>> {
+    using next = StaticTaskAt<I - 1, StaticTasks<Rest...>>;
+    using type = typename next::type;
+
+    static type &get(StaticTasks<T, Rest...> &tasks) {
+        return next::get(tasks.rest);
+    }
+};
+
+// Scheduler for a set of tasks known at compile time. Tasks are any types
+// with the methods of StaticPeriodicTask, checked in order like Scheduler
+// without a queue, but with every call resolved statically. For a few
+// tasks on a small MCU, where an indirect call and vtable load per task
+// every second adds up. Tasks can't be added or removed.
+template<typename... Tasks>
+class StaticScheduler {
+public:
+    static constexpr size_t Size = sizeof...(Tasks);
+
+private:
+    StaticTasks<Tasks...> tasks_;
+    uint32_t last_now_{ 0 };
+
+public:
+    StaticScheduler(Tasks... tasks) : tasks_(tasks...) {
+    }
+
+public:
+    template<size_t I>
+    typename StaticTaskAt<I, StaticTasks<Tasks...>>::type &get() {
+        return StaticTaskAt<I, StaticTasks<Tasks...>>::get(tasks_);
+    }
+
+    size_t size() const {
+        return Size;
+    }
+
+    void begin(DateTime now) {
+        tasks_.begin(now);
+    }
+
+    // Runs every task that's due and returns how many.
+    size_t check(DateTime now, uint32_t seed = 0) {
+        auto now_unix = now.unix_time();
+        auto difference = (int64_t)now_unix - (int64_t)last_now_;
+        last_now_ = now_unix;
+        if (difference < -(int64_t)RerunThreshold) {
+            begin(now);
+            return 0;
+        }
+        return tasks_.check(now_unix, now + 1, seed);
+    }
+
+    // Earliest scheduled time, or zero if no task is enabled.
+    uint32_t nextTime() const {
+        return tasks_.nextTime(0);
+    }
+
+    uint32_t secondsUntilNextTask(DateTime now) const {
+        auto next = nextTime();
+        if (next == 0) {
+            return UINT32_MAX;
+        }
+        auto now_unix = now.unix_time();
+        if (next <= now_unix) {
+            return 0;
+        }
+        return next - now_unix;
+    }
+
+};
+
+template<typename... Tasks>
+constexpr size_t StaticScheduler<Tasks...>::Size;
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef LWCRON_SUBMISSIONS_H_INCLUDED
+#define LWCRON_SUBMISSIONS_H_INCLUDED
+
+// Needs atomics the MCU doesn't have, so hosted builds only.
+#if !defined(ARDUINO)
+
+#include <atomic>
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Lets any number of threads add, remove and refresh tasks while another
+// thread is in Scheduler::check, without taking locks. Requests go into
+// a bounded ring (Dmitry Vyukov's MPMC queue, with a single consumer)
+// and check applies them before anything else. Give the scheduler to it
+// with Scheduler::changes.
+//
+// Only the dispatching thread ever touches a task's schedule, so once a
+// task is submitted it shouldn't be changed other than through here. A
+// removed task has to outlive the check that removes it.
+template<size_t N>
+class Submissions : public TaskChanges {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    enum class Operation : uint8_t {
+        Add,
+        Remove,
+        Refresh,
+    };
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Operation operation;
+        Task *task;
+    };
+
+    Cell cells_[N];
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+    alignas(64) size_t head_{ 0 };
+    std::atomic<uint32_t> applied_{ 0 };
+    std::atomic<uint32_t> failed_{ 0 };
+
+public:
+    Submissions() {
+        for (auto i = (size_t)0; i < N; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    // These return false when the ring is full, retry after the next check.
+    bool add(Task *task) {
+        return submit(Operation::Add, task);
+    }
+
+    bool remove(Task *task) {
+        return submit(Operation::Remove, task);
+    }
+
+    bool refresh(Task *task) {
+        return submit(Operation::Refresh, task);
+    }
+
+    bool submit(Operation operation, Task *task) {
+        auto position = tail_.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells_[position & (N - 1)];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->operation = operation;
+        cell->task = task;
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        return true;
+    }
+
+public:
+    // Requests applied, and ones the scheduler turned down because it was
+    // full or didn't have the task.
+    uint32_t applied() const {
+        return applied_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t failed() const {
+        return failed_.load(std::memory_order_relaxed);
+    }
+
+    // Only from the thread calling check.
+    void apply(Scheduler &scheduler, DateTime now) override {
+        while (true) {
+            auto &cell = cells_[head_ & (N - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                return;
+            }
+
+            auto ok = false;
+            switch (cell.operation) {
+            case Operation::Add: ok = scheduler.add(cell.task, now); break;
+            case Operation::Remove: ok = scheduler.remove(cell.task); break;
+            case Operation::Refresh: ok = scheduler.refresh(cell.task, now); break;
+            }
+
+            cell.sequence.store(head_ + N, std::memory_order_release);
+            head_++;
+
+            if (ok) {
+                applied_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                failed_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+};
+
+}
+
+#endif
+
+#endif
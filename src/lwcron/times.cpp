@@ -0,0 +1,87 @@
+#include "times.h"
+
+namespace lwcron {
+
+FireTimes::FireTimes(CronSpec spec, DateTime from, DateTime to) : spec_(spec), to_(to.unix_time()) {
+    time_ = spec_.getNextTime(from);
+}
+
+FireTimes::FireTimes(Task const &task, DateTime from, DateTime to, uint32_t seed) : task_(&task), seed_(seed), to_(to.unix_time()) {
+    if (task.valid()) {
+        time_ = task.getNextTime(from, seed);
+    }
+}
+
+void FireTimes::advance() {
+    if (done()) {
+        return;
+    }
+    if (task_ != nullptr) {
+        time_ = task_->getNextTimeFrom(time_, time_ + 1, seed_);
+        return;
+    }
+    auto following = spec_.getFollowingTime(time_);
+    time_ = following != 0 ? following : spec_.getNextTime(time_ + 1);
+}
+
+size_t FireTimes::fill(uint32_t *times, size_t size) {
+    auto n = (size_t)0;
+    while (n < size && !done()) {
+        times[n++] = time_;
+        advance();
+    }
+    return n;
+}
+
+SchedulerTimes::SchedulerTimes(Scheduler const &scheduler, HeapQueue &queue, DateTime from, DateTime to, uint32_t seed) :
+    scheduler_(&scheduler), queue_(&queue), seed_(seed), to_(to.unix_time()) {
+    queue.clear(from.unix_time());
+    for (auto i = (size_t)0; i < scheduler.size(); ++i) {
+        auto task = scheduler.get(i);
+        if (task->valid() && task->enabled()) {
+            auto time = task->getNextTime(from, seed);
+            if (time != 0 && time < to_) {
+                queue.push(i, time);
+            }
+        }
+    }
+}
+
+bool SchedulerTimes::done() const {
+    return queue_->size() == 0;
+}
+
+Scheduler::TaskAndTime SchedulerTimes::current() const {
+    uint32_t index;
+    uint32_t time;
+    if (!queue_->peek(index, time)) {
+        return { };
+    }
+    return Scheduler::TaskAndTime{ time, scheduler_->get(index) };
+}
+
+void SchedulerTimes::advance() {
+    uint32_t index;
+    uint32_t time;
+    if (!queue_->peek(index, time)) {
+        return;
+    }
+    auto next = scheduler_->get(index)->getNextTimeFrom(time, time + 1, seed_);
+    if (next != 0 && next < to_) {
+        queue_->push(index, next);
+    }
+    else {
+        queue_->remove(index);
+    }
+}
+
+size_t SchedulerTimes::fill(Scheduler::TaskAndTime *times, size_t size) {
+    auto n = (size_t)0;
+    while (n < size && !done()) {
+        times[n++] = current();
+        advance();
+    }
+    return n;
+}
+
+}
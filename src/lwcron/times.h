@@ -0,0 +1,157 @@
+#ifndef LWCRON_TIMES_H_INCLUDED
+#define LWCRON_TIMES_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// The times a CronSpec or a Task fires from from up to, but not
+// including, to. Each step moves on from the previous time, with
+// CronSpec::getFollowingTime or Task::getNextTimeFrom, rather than
+// working it out again, so it's O(1) unless a day boundary's crossed.
+// Nothing is changed, so a scheduler's tasks can be looked ahead at
+// while it's running.
+class FireTimes {
+public:
+    class iterator {
+    private:
+        FireTimes *times_;
+
+    public:
+        iterator(FireTimes *times) : times_(times) {
+        }
+
+    public:
+        uint32_t operator*() const {
+            return times_->time();
+        }
+
+        iterator &operator++() {
+            times_->advance();
+            return *this;
+        }
+
+        bool operator!=(iterator const &other) const {
+            return done() != other.done();
+        }
+
+    private:
+        bool done() const {
+            return times_ == nullptr || times_->done();
+        }
+    };
+
+private:
+    CronSpec spec_;
+    Task const *task_{ nullptr };
+    uint32_t seed_{ 0 };
+    uint32_t time_{ 0 };
+    uint32_t to_{ 0 };
+
+public:
+    FireTimes(CronSpec spec, DateTime from, DateTime to);
+
+    FireTimes(Task const &task, DateTime from, DateTime to, uint32_t seed = 0);
+
+public:
+    bool done() const {
+        return time_ == 0 || time_ >= to_;
+    }
+
+    uint32_t time() const {
+        return time_;
+    }
+
+    void advance();
+
+    // Bulk version, fills times with up to size times and returns how
+    // many. Call again for more.
+    size_t fill(uint32_t *times, size_t size);
+
+    template<size_t N>
+    size_t fill(uint32_t (&times)[N]) {
+        return fill(&times[0], N);
+    }
+
+public:
+    iterator begin() {
+        return iterator{ this };
+    }
+
+    iterator end() {
+        return iterator{ nullptr };
+    }
+
+};
+
+// Every task's fire times, merged into time order, ties to the lowest
+// index like Scheduler::check. The queue is where each task's next time
+// is kept and needs the scheduler's capacity. Each step is O(1) for the
+// task and O(log n) to find the next task.
+class SchedulerTimes {
+public:
+    class iterator {
+    private:
+        SchedulerTimes *times_;
+
+    public:
+        iterator(SchedulerTimes *times) : times_(times) {
+        }
+
+    public:
+        Scheduler::TaskAndTime operator*() const {
+            return times_->current();
+        }
+
+        iterator &operator++() {
+            times_->advance();
+            return *this;
+        }
+
+        bool operator!=(iterator const &other) const {
+            return done() != other.done();
+        }
+
+    private:
+        bool done() const {
+            return times_ == nullptr || times_->done();
+        }
+    };
+
+private:
+    Scheduler const *scheduler_;
+    HeapQueue *queue_;
+    uint32_t seed_;
+    uint32_t to_;
+
+public:
+    SchedulerTimes(Scheduler const &scheduler, HeapQueue &queue, DateTime from, DateTime to, uint32_t seed = 0);
+
+public:
+    bool done() const;
+
+    Scheduler::TaskAndTime current() const;
+
+    void advance();
+
+    size_t fill(Scheduler::TaskAndTime *times, size_t size);
+
+    template<size_t N>
+    size_t fill(Scheduler::TaskAndTime (&times)[N]) {
+        return fill(&times[0], N);
+    }
+
+public:
+    iterator begin() {
+        return iterator{ this };
+    }
+
+    iterator end() {
+        return iterator{ nullptr };
+    }
+
+};
+
+}
+
+#endif
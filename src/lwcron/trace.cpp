@@ -0,0 +1,168 @@
+#include "trace.h"
+
+#if !defined(ARDUINO)
+#include <vector>
+#endif
+
+namespace lwcron {
+
+constexpr uint32_t TraceEvent::NoTask;
+
+static inline size_t round_down_power_of_two(size_t value) {
+    auto rounded = (size_t)1;
+    while (rounded * 2 <= value) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+TraceBuffer::TraceBuffer(TraceEvent *events, size_t capacity) : events_(events), mask_((uint32_t)round_down_power_of_two(capacity) - 1) {
+}
+
+size_t TraceBuffer::read(uint32_t &cursor, TraceEvent *events, size_t size) const {
+    auto capacity = mask_ + 1;
+    auto head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    // The oldest slot is the next one the recorder writes over.
+    if (head - cursor > capacity - 1) {
+        cursor = head - (capacity - 1);
+    }
+
+    auto from = cursor;
+    auto n = (size_t)0;
+    while (n < size && from + n != head) {
+        auto &slot = events_[(from + n) & mask_];
+        auto &event = events[n];
+        event.micros = __atomic_load_n(&slot.micros, __ATOMIC_RELAXED);
+        event.time = __atomic_load_n(&slot.time, __ATOMIC_RELAXED);
+        event.task = __atomic_load_n(&slot.task, __ATOMIC_RELAXED);
+        event.type = (TraceType)__atomic_load_n((uint8_t const *)&slot.type, __ATOMIC_RELAXED);
+        for (auto i = 0; i < 3; ++i) {
+            event.reserved[i] = __atomic_load_n(&slot.reserved[i], __ATOMIC_RELAXED);
+        }
+        n++;
+    }
+
+    // The recorder may have come round and be part way through writing
+    // over what was just copied, everything from the slot it's on now
+    // back to the oldest copied could be torn. The fence keeps the copies
+    // above from moving past the load of head, an acquire load wouldn't.
+    trace_acquire_fence();
+    auto after = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+    auto torn = (size_t)0;
+    if (after - from >= capacity) {
+        torn = after - from - capacity + 1;
+        if (torn > n) {
+            torn = n;
+        }
+    }
+    if (torn > 0) {
+        memmove(events, events + torn, (n - torn) * sizeof(TraceEvent));
+    }
+
+    cursor = from + n;
+    return n - torn;
+}
+
+#if !defined(ARDUINO)
+
+static void write_json_string(FILE *file, const char *value) {
+    fputc('"', file);
+    for (auto p = value; *p != 0; ++p) {
+        auto c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            fprintf(file, "\\%c", c);
+        }
+        else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        }
+        else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void write_task_name(FILE *file, uint32_t task, const char *const *names, size_t number_of_names) {
+    if (task < number_of_names && names[task] != nullptr) {
+        write_json_string(file, names[task]);
+    }
+    else {
+        fprintf(file, "\"task %" PRIu32 "\"", task);
+    }
+}
+
+bool trace_to_chrome_json(FILE *file, TraceEvent const *events, size_t size, const char *const *names, size_t number_of_names) {
+    // Tasks are threads of one process, the scheduler itself is thread 0.
+    std::vector<bool> named;
+    auto wrapped = (uint64_t)0;
+    auto previous = (uint32_t)0;
+    auto check_micros = (uint64_t)0;
+    auto check_now = (uint32_t)0;
+    auto checked = false;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"scheduler\"}}");
+
+    for (auto i = (size_t)0; i < size; ++i) {
+        auto &event = events[i];
+        if (i > 0 && event.micros < previous) {
+            wrapped += 1ull << 32;
+        }
+        previous = event.micros;
+        auto ts = wrapped + event.micros;
+        auto tid = event.task == TraceEvent::NoTask ? 0u : event.task + 1u;
+
+        if (tid > 0) {
+            if (named.size() < tid + 1) {
+                named.resize(tid + 1);
+            }
+            if (!named[tid]) {
+                named[tid] = true;
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", tid);
+                write_task_name(file, event.task, names, number_of_names);
+                fprintf(file, "}}");
+            }
+        }
+
+        switch (event.type) {
+        case TraceType::Check: {
+            check_micros = ts;
+            check_now = event.time;
+            checked = true;
+            fprintf(file, ",\n{\"name\":\"check\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":0,\"ts\":%" PRIu64 ",\"args\":{\"now\":%" PRIu32 "}}",
+                    ts, event.time);
+            break;
+        }
+        case TraceType::Due: {
+            // Due events are stamped with their check's clock.
+            auto now = checked && check_micros == ts ? check_now : event.time;
+            auto late = now > event.time ? (uint64_t)(now - event.time) * 1000000 : (uint64_t)0;
+            auto due = late < ts ? ts - late : (uint64_t)0;
+            fprintf(file, ",\n{\"name\":\"due\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ",\"args\":{\"scheduled\":%" PRIu32 ",\"now\":%" PRIu32 "}}",
+                    tid, due, ts - due, event.time, now);
+            break;
+        }
+        case TraceType::RunBegin:
+        case TraceType::RunEnd: {
+            fprintf(file, ",\n{\"name\":");
+            write_task_name(file, event.task, names, number_of_names);
+            fprintf(file, ",\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu64 "}",
+                    event.type == TraceType::RunBegin ? "B" : "E", tid, ts);
+            break;
+        }
+        case TraceType::Rebegin: {
+            fprintf(file, ",\n{\"name\":\"rebegin\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%" PRIu64 ",\"args\":{\"from\":%" PRIu32 ",\"to\":%" PRIu32 "}}",
+                    ts, event.time, checked ? check_now : event.time);
+            break;
+        }
+        }
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return ferror(file) == 0;
+}
+
+#endif
+
+}
@@ -0,0 +1,127 @@
+#ifndef LWCRON_TRACE_H_INCLUDED
+#define LWCRON_TRACE_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+enum class TraceType : uint8_t {
+    // check was called, time is now.
+    Check,
+    // A task was found due, time is when it was scheduled for.
+    Due,
+    // Around the task's run, time is now.
+    RunBegin,
+    RunEnd,
+    // The clock went back and the schedule began again, time is the
+    // time before, the check's now is the time after.
+    Rebegin,
+};
+
+// 16 bytes, laid out the same on the MCU and hosts, so a dump of the
+// buffer's memory can be converted as is. Tasks are their index in the
+// scheduler, which can go past what 16 bits hold.
+struct TraceEvent {
+    static constexpr uint32_t NoTask = UINT32_MAX;
+
+    // Microsecond clock, which wraps every 71 minutes or so.
+    uint32_t micros;
+    uint32_t time;
+    uint32_t task;
+    TraceType type;
+    uint8_t reserved[3];
+};
+
+// GCC warns that ThreadSanitizer doesn't understand fences, which only
+// means it can't check the ordering they give, so quiet that.
+#if defined(__SANITIZE_THREAD__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wtsan"
+#endif
+
+static inline void trace_acquire_fence() {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static inline void trace_release_fence() {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+#if defined(__SANITIZE_THREAD__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+
+// Flight recorder for Scheduler, given to it with Scheduler::trace. The
+// newest events overwrite the oldest and recording never waits, it's a
+// store into the ring and a release store of the head. Events can be
+// read out from another thread, or an interrupt, while the scheduler's
+// running. The capacity is rounded down to a power of two.
+class TraceBuffer {
+private:
+    TraceEvent *events_;
+    uint32_t mask_;
+    uint32_t head_{ 0 };
+
+public:
+    TraceBuffer(TraceEvent *events, size_t capacity);
+
+    template<size_t N>
+    TraceBuffer(TraceEvent (&events)[N]) : TraceBuffer(&events[0], N) {
+    }
+
+public:
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    // Number of events ever recorded, which is where a reader that's
+    // only interested in new events starts.
+    uint32_t recorded() const {
+        return __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    }
+
+    // Only the scheduler's thread records. Slots are written with atomic
+    // stores so a reader copying one at the same time isn't a data race,
+    // they're plain stores on anything this runs on.
+    void record(TraceType type, uint32_t micros, uint32_t time, uint32_t task) {
+        auto head = head_;
+        auto &event = events_[head & mask_];
+        // Nothing written into the slot can be seen before the last head,
+        // which is what tells a reader the slot's being written over.
+        trace_release_fence();
+        __atomic_store_n(&event.micros, micros, __ATOMIC_RELAXED);
+        __atomic_store_n(&event.time, time, __ATOMIC_RELAXED);
+        __atomic_store_n(&event.task, task, __ATOMIC_RELAXED);
+        __atomic_store_n((uint8_t *)&event.type, (uint8_t)type, __ATOMIC_RELAXED);
+        for (auto &reserved : event.reserved) {
+            __atomic_store_n(&reserved, (uint8_t)0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&head_, head + 1, __ATOMIC_RELEASE);
+    }
+
+    // Copies events from cursor on, oldest first, up to size of them and
+    // moves cursor past them. Anything overwritten before it could be
+    // read is skipped, so at most the newest capacity - 1 are read.
+    size_t read(uint32_t &cursor, TraceEvent *events, size_t size) const;
+
+    template<size_t N>
+    size_t read(uint32_t &cursor, TraceEvent (&events)[N]) const {
+        return read(cursor, &events[0], N);
+    }
+
+};
+
+#if !defined(ARDUINO)
+
+// Writes events as Chrome trace JSON, which chrome://tracing and Perfetto
+// open. Each task gets a track, labelled with names if there's one for
+// its index. Due events are drawn as a slice from the scheduled time,
+// taking the check's second as starting at the check, to when the check
+// noticed.
+bool trace_to_chrome_json(FILE *file, TraceEvent const *events, size_t size, const char *const *names = nullptr, size_t number_of_names = 0);
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,276 @@
+#include "wheel.h"
+
+namespace lwcron {
+
+constexpr uint32_t TimingWheel::Days;
+constexpr uint32_t TimingWheel::None;
+
+size_t TimingWheel::size() const {
+    auto size = (size_t)0;
+    for (auto i = 0; i < Levels; ++i) {
+        size += counts_[i];
+    }
+    return size;
+}
+
+void TimingWheel::clear(uint32_t now) {
+    for (auto &head : seconds_) {
+        head = None;
+    }
+    for (auto &head : minutes_) {
+        head = None;
+    }
+    for (auto &head : hours_) {
+        head = None;
+    }
+    for (auto &head : days_) {
+        head = None;
+    }
+    for (auto &count : counts_) {
+        count = 0;
+    }
+    for (auto i = (size_t)0; i < capacity_; ++i) {
+        slots_[i].level = Levels;
+    }
+    overflow_ = None;
+    expired_ = None;
+    cursor_ = now;
+}
+
+bool TimingWheel::push(uint32_t index, uint32_t time) {
+    if (index >= capacity_) {
+        return false;
+    }
+    if (queued(index)) {
+        unlink(index);
+    }
+    slots_[index].time = time;
+    place(index);
+    return true;
+}
+
+bool TimingWheel::peek(uint32_t &index, uint32_t &time) {
+    if (earliest(expired_, index, time)) {
+        return true;
+    }
+    if (earliest(seconds_, cursor_ % 60 + 1, 60, 60, index, time)) {
+        return true;
+    }
+    if (earliest(minutes_, (cursor_ / 60) % 60 + 1, 60, 60, index, time)) {
+        return true;
+    }
+    if (earliest(hours_, (cursor_ / 3600) % 24 + 1, 24, 24, index, time)) {
+        return true;
+    }
+    auto today = cursor_ / 86400;
+    if (earliest(days_, today + 1, today + Days, Days, index, time)) {
+        return true;
+    }
+    return earliest(overflow_, index, time);
+}
+
+bool TimingWheel::pop(uint32_t now, uint32_t &index) {
+    advance(now);
+
+    // After the clock steps back a little the expired list can hold
+    // entries that aren't due yet.
+    for (auto i = expired_; i != None; i = slots_[i].next) {
+        if (slots_[i].time <= now) {
+            unlink(i);
+            index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TimingWheel::remove(uint32_t index) {
+    if (!queued(index)) {
+        return false;
+    }
+    unlink(index);
+    return true;
+}
+
+bool TimingWheel::move(uint32_t from, uint32_t to) {
+    if (to >= capacity_ || !queued(from) || queued(to)) {
+        return false;
+    }
+    auto &slot = slots_[from];
+    if (slot.previous == None) {
+        head(from) = to;
+    }
+    else {
+        slots_[slot.previous].next = to;
+    }
+    if (slot.next != None) {
+        slots_[slot.next].previous = to;
+    }
+    slots_[to] = slot;
+    slot.level = Levels;
+    return true;
+}
+
+bool TimingWheel::queued(uint32_t index) const {
+    return index < capacity_ && slots_[index].level != Levels;
+}
+
+// Which list an entry is in follows from its level and time.
+uint32_t &TimingWheel::head(uint32_t index) {
+    auto time = slots_[index].time;
+    switch (slots_[index].level) {
+    case Seconds: return seconds_[time % 60];
+    case Minutes: return minutes_[(time / 60) % 60];
+    case Hours: return hours_[(time / 3600) % 24];
+    case DaysLevel: return days_[(time / 86400) % Days];
+    case Overflow: return overflow_;
+    default: return expired_;
+    }
+}
+
+void TimingWheel::link(uint32_t index, uint32_t &head, Level level) {
+    auto &slot = slots_[index];
+    slot.next = head;
+    slot.previous = None;
+    slot.level = level;
+    if (head != None) {
+        slots_[head].previous = index;
+    }
+    head = index;
+    counts_[level]++;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    auto &slot = slots_[index];
+    if (slot.previous == None) {
+        head(index) = slot.next;
+    }
+    else {
+        slots_[slot.previous].next = slot.next;
+    }
+    if (slot.next != None) {
+        slots_[slot.next].previous = slot.previous;
+    }
+    counts_[slot.level]--;
+    slot.level = Levels;
+}
+
+void TimingWheel::advance(uint32_t now) {
+    while (cursor_ < now) {
+        auto minute_end = cursor_ - cursor_ % 60 + 59;
+        auto until = now < minute_end ? now : minute_end;
+        auto from = cursor_ % 60 + 1;
+        cursor_ = until;
+        if (counts_[Seconds] > 0) {
+            for (auto s = from; s <= until % 60; ++s) {
+                cascade(seconds_[s], Seconds);
+            }
+        }
+        if (until == now) {
+            break;
+        }
+
+        // Skip over minutes, hours and days that can't have anything in
+        // them, rather than visiting every one.
+        auto next = minute_end + 1;
+        if (counts_[Seconds] == 0 && counts_[Minutes] == 0) {
+            next = cursor_ - cursor_ % 3600 + 3600;
+            if (counts_[Hours] == 0) {
+                next = cursor_ - cursor_ % 86400 + 86400;
+                if (counts_[DaysLevel] == 0) {
+                    if (counts_[Overflow] == 0) {
+                        cursor_ = now;
+                        break;
+                    }
+                    // Only far off entries, like those pushed before the
+                    // first clear, go straight to the earliest one's day.
+                    uint32_t index = None;
+                    uint32_t time = 0;
+                    if (earliest(overflow_, index, time) && time - time % 86400 > next) {
+                        next = time - time % 86400;
+                    }
+                }
+            }
+        }
+        if (next > now) {
+            cursor_ = now;
+            break;
+        }
+
+        cursor_ = next;
+        if (next % 86400 == 0) {
+            cascade(overflow_, Overflow);
+            cascade(days_[(next / 86400) % Days], DaysLevel);
+        }
+        if (next % 3600 == 0) {
+            cascade(hours_[(next / 3600) % 24], Hours);
+        }
+        cascade(minutes_[(next / 60) % 60], Minutes);
+    }
+}
+
+void TimingWheel::place(uint32_t index) {
+    auto time = slots_[index].time;
+    auto head = &expired_;
+    auto level = Expired;
+    if (time > cursor_) {
+        if (time / 60 == cursor_ / 60) {
+            head = &seconds_[time % 60];
+            level = Seconds;
+        }
+        else if (time / 3600 == cursor_ / 3600) {
+            head = &minutes_[(time / 60) % 60];
+            level = Minutes;
+        }
+        else if (time / 86400 == cursor_ / 86400) {
+            head = &hours_[(time / 3600) % 24];
+            level = Hours;
+        }
+        else if (time / 86400 - cursor_ / 86400 < Days) {
+            head = &days_[(time / 86400) % Days];
+            level = DaysLevel;
+        }
+        else {
+            head = &overflow_;
+            level = Overflow;
+        }
+    }
+    link(index, *head, level);
+}
+
+void TimingWheel::cascade(uint32_t &head, Level level) {
+    auto i = head;
+    head = None;
+    while (i != None) {
+        auto next = slots_[i].next;
+        counts_[level]--;
+        slots_[i].level = Levels;
+        place(i);
+        i = next;
+    }
+}
+
+bool TimingWheel::earliest(uint32_t head, uint32_t &index, uint32_t &time) const {
+    auto found = false;
+    for (auto i = head; i != None; i = slots_[i].next) {
+        auto t = slots_[i].time;
+        if (!found || t < time || (t == time && i < index)) {
+            index = i;
+            time = t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool TimingWheel::earliest(uint32_t const *heads, uint32_t from, uint32_t to, uint32_t wrap, uint32_t &index, uint32_t &time) const {
+    for (auto i = from; i < to; ++i) {
+        if (earliest(heads[i % wrap], index, time)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef LWCRON_WHEEL_H_INCLUDED
+#define LWCRON_WHEEL_H_INCLUDED
+
+#include "lwcron.h"
+
+namespace lwcron {
+
+// Hierarchical timing wheel with second, minute, hour and day wheels.
+// Entries are kept in a wheel slot for the smallest unit that still
+// separates them from the current time and move down a wheel as that
+// unit comes around, so push and pop are O(1) amortized. Tasks due in
+// the same second come out in no particular order.
+class TimingWheel : public TaskQueue {
+public:
+    static constexpr uint32_t Days = 64;
+
+    struct Slot {
+        uint32_t time;
+        uint32_t next;
+        uint32_t previous;
+        uint32_t level;
+    };
+
+private:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    enum Level {
+        Seconds,
+        Minutes,
+        Hours,
+        DaysLevel,
+        Overflow,
+        Expired,
+        Levels,
+    };
+
+    Slot *slots_{ nullptr };
+    size_t capacity_{ 0 };
+    uint32_t cursor_{ 0 };
+    uint32_t seconds_[60];
+    uint32_t minutes_[60];
+    uint32_t hours_[24];
+    uint32_t days_[Days];
+    uint32_t overflow_{ None };
+    uint32_t expired_{ None };
+    uint32_t counts_[Levels];
+
+public:
+    TimingWheel(Slot *slots, size_t capacity) : slots_(slots), capacity_(capacity) {
+        clear(0);
+    }
+
+    template<size_t N>
+    TimingWheel(Slot (&slots)[N]) : TimingWheel(&slots[0], N) {
+    }
+
+public:
+    size_t size() const;
+
+public:
+    void clear(uint32_t now) override;
+    bool push(uint32_t index, uint32_t time) override;
+    bool peek(uint32_t &index, uint32_t &time) override;
+    bool pop(uint32_t now, uint32_t &index) override;
+    bool remove(uint32_t index) override;
+    bool move(uint32_t from, uint32_t to) override;
+
+private:
+    bool queued(uint32_t index) const;
+    uint32_t &head(uint32_t index);
+    void link(uint32_t index, uint32_t &head, Level level);
+    void unlink(uint32_t index);
+    void advance(uint32_t now);
+    void place(uint32_t index);
+    void cascade(uint32_t &head, Level level);
+    bool earliest(uint32_t head, uint32_t &index, uint32_t &time) const;
+    bool earliest(uint32_t const *heads, uint32_t from, uint32_t to, uint32_t wrap, uint32_t &index, uint32_t &time) const;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#if !defined(ARDUINO)
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/compiled.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class CompiledCronSpecSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(CompiledCronSpecSuite, MatchesCronSpec) {
+    std::vector<CronSpec> specs = {
+        CronSpec::everyFiveMinutes(),
+        CronSpec::everyTwentyMinutes(),
+        CronSpec::specific(0, 15, 6),
+        CronSpec::specific(59, 59, 23),
+        CronSpec::specific(30),
+        CronSpec::interval(7),
+        CronSpec::interval(90),
+        CronSpec::interval(7200),
+        CronSpec::bits(1ull << 10 | 1ull << 50, 1ull << 0 | 1ull << 59, 1u << 0 | 1u << 12 | 1u << 23),
+        CronSpec{ },
+    };
+
+    for (auto &spec : specs) {
+        CompiledCronSpec compiled{ spec };
+        for (auto i = 0u; i < 86400 * 2; i += 13) {
+            auto after = JacobsBirth + i;
+            ASSERT_EQ(compiled.getNextTime(after), spec.getNextTime(after));
+        }
+    }
+}
+
+TEST_F(CompiledCronSpecSuite, SharedBetweenTasks) {
+    CompiledCronSpecs specs;
+    std::vector<CompiledCronTask> tasks;
+    for (auto i = 0u; i < 100; ++i) {
+        tasks.emplace_back(specs, i % 2 == 0 ? CronSpec::everyFiveMinutes() : CronSpec::specific(0, 0), 10);
+    }
+
+    // Nothing's built until it's needed.
+    ASSERT_EQ(specs.size(), 0u);
+
+    for (auto &task : tasks) {
+        auto expected = CronTask{ task.spec(), task.jitter() }.getNextTime(JacobsBirth + 1, 1234);
+        ASSERT_EQ(task.getNextTime(JacobsBirth + 1, 1234), expected);
+    }
+
+    ASSERT_EQ(specs.size(), 2u);
+    ASSERT_GE(specs.memory(), 2 * sizeof(CompiledCronSpec));
+    ASSERT_LT(specs.memory(), 4 * sizeof(CompiledCronSpec));
+}
+
+TEST_F(CompiledCronSpecSuite, SchedulerRunsTheSameAsCronTask) {
+    std::vector<CronSpec> specs = {
+        CronSpec::everyFiveMinutes(),
+        CronSpec::specific(0, 15, 6),
+        CronSpec::interval(7),
+        CronSpec::interval(90),
+        CronSpec::bits(1ull << 10 | 1ull << 50, 1ull << 0 | 1ull << 59, 1u << 0 | 1u << 12 | 1u << 23),
+    };
+
+    CompiledCronSpecs compiled_specs;
+    std::vector<CronTask> cron;
+    std::vector<CompiledCronTask> compiled;
+    for (auto i = 0u; i < specs.size() * 2; ++i) {
+        auto jitter = i < specs.size() ? 0 : 30;
+        cron.emplace_back(specs[i % specs.size()], jitter);
+        compiled.emplace_back(compiled_specs, specs[i % specs.size()], jitter);
+    }
+
+    // Rescheduling goes through getNextTimeFrom, which has to use the
+    // table too.
+    ASSERT_EQ(compiled[0].getNextTimeFrom(JacobsBirth.unix_time(), JacobsBirth + 1, 0), cron[0].getNextTimeFrom(JacobsBirth.unix_time(), JacobsBirth + 1, 0));
+    ASSERT_EQ(compiled_specs.size(), 1u);
+
+    std::vector<Task*> cron_pointers;
+    std::vector<Task*> compiled_pointers;
+    for (auto i = (size_t)0; i < cron.size(); ++i) {
+        cron_pointers.push_back(&cron[i]);
+        compiled_pointers.push_back(&compiled[i]);
+    }
+
+    Scheduler cron_scheduler{ cron_pointers.data(), cron_pointers.size() };
+    Scheduler compiled_scheduler{ compiled_pointers.data(), compiled_pointers.size() };
+
+    auto simulate = [](Scheduler &scheduler, std::vector<Task*> &pointers) {
+        std::vector<std::pair<uint32_t, size_t>> fired;
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+        // Every second, then late by varying amounts.
+        for (auto i = 0u; i < 86400 * 2; i += (i < 86400 ? 1 : 1 + i % 97)) {
+            while (auto tt = scheduler.check(JacobsBirth + i, 1234 + i)) {
+                fired.emplace_back(tt.time, std::find(pointers.begin(), pointers.end(), tt.task) - pointers.begin());
+            }
+        }
+        return fired;
+    };
+
+    auto expected = simulate(cron_scheduler, cron_pointers);
+    ASSERT_EQ(simulate(compiled_scheduler, compiled_pointers), expected);
+    ASSERT_GT(expected.size(), 10000u);
+}
+
+#endif
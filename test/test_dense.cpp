@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/dense.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class DenseQueueSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(DenseQueueSuite, DueMatchesScalarScan) {
+    // Either side of the sign bit too, which the vector compares flip.
+    uint32_t values[] = { 0, 1, 0x7fffffff, 0x80000000, 0x80000001, 388395000, UINT32_MAX - 1, DenseQueue::None };
+
+    auto seed = 1u;
+    for (auto size = (size_t)0; size < 40; ++size) {
+        std::vector<uint32_t> times(size);
+        for (auto round = 0; round < 50; ++round) {
+            for (auto &time : times) {
+                seed = seed * 1103515245 + 12345;
+                time = values[(seed >> 16) % 8];
+            }
+            for (auto now : values) {
+                for (auto from = (size_t)0; from <= size; ++from) {
+                    auto expected = size;
+                    for (auto i = from; i < size; ++i) {
+                        if (times[i] <= now) {
+                            expected = i;
+                            break;
+                        }
+                    }
+                    ASSERT_EQ(DenseQueue::due(times.data(), from, size, now), expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DenseQueueSuite, SchedulerRunsTheSameTasksAsScanning) {
+    std::vector<PeriodicTask> periodic;
+    std::vector<CronTask> cron;
+    for (auto i = 0u; i < 50; ++i) {
+        periodic.emplace_back(5 + i * 37);
+    }
+    cron.emplace_back(CronSpec::specific(15, 45));
+    cron.emplace_back(CronSpec::specific(0, 0, 3));
+    cron.emplace_back(CronSpec::everyFiveMinutes());
+
+    std::vector<Task*> tasks;
+    for (auto &task : periodic) {
+        tasks.push_back(&task);
+    }
+    for (auto &task : cron) {
+        tasks.push_back(&task);
+    }
+
+    std::vector<uint32_t> times(tasks.size());
+    DenseQueue dense{ times.data(), times.size() };
+
+    Scheduler scanned{ tasks.data(), tasks.size() };
+    Scheduler densed{ tasks.data(), tasks.size(), dense };
+
+    // Every second for a while, then larger steps, so several tasks are
+    // due at different times in the same check.
+    std::vector<uint32_t> steps;
+    for (auto i = 0; i < 60 * 60 * 2; ++i) {
+        steps.push_back(1);
+    }
+    for (auto i = 0; i < 400; ++i) {
+        steps.push_back(61 * 60 + i);
+    }
+
+    auto simulate = [&](Scheduler &scheduler) {
+        std::vector<std::pair<uint32_t, Task*>> fired;
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+        for (auto step : steps) {
+            while (auto tt = scheduler.check(now)) {
+                fired.emplace_back(tt.time, tt.task);
+            }
+            now += step;
+        }
+        return fired;
+    };
+
+    auto expected = simulate(scanned);
+    ASSERT_EQ(simulate(densed), expected);
+    ASSERT_GT(expected.size(), 1000u);
+}
+
+TEST_F(DenseQueueSuite, RemoveAndMove) {
+    uint32_t slots[8];
+    DenseQueue dense{ slots };
+
+    auto now = JacobsBirth.unix_time();
+    dense.clear(now);
+
+    uint32_t times[] = { now + 86400 * 100, now + 3, now + 70, now + 3600 * 5, now + 86400 * 3, now + 3 };
+    for (auto i = 0u; i < 6; ++i) {
+        ASSERT_TRUE(dense.push(i, times[i]));
+    }
+
+    ASSERT_TRUE(dense.remove(3));
+    ASSERT_FALSE(dense.remove(3));
+    ASSERT_TRUE(dense.move(5, 7));
+    ASSERT_FALSE(dense.move(5, 6));
+    ASSERT_TRUE(dense.move(0, 6));
+    // Pushing something already queued moves it.
+    ASSERT_TRUE(dense.push(2, now + 2));
+    ASSERT_EQ(dense.size(), 5u);
+
+    uint32_t index;
+    uint32_t time;
+    ASSERT_TRUE(dense.peek(index, time));
+    ASSERT_EQ(index, 2u);
+    ASSERT_EQ(time, now + 2);
+
+    // Lowest index first among those due.
+    uint32_t expected[] = { 1, 2, 7 };
+    for (auto i : expected) {
+        ASSERT_TRUE(dense.pop(now + 3, index));
+        ASSERT_EQ(index, i);
+    }
+    ASSERT_FALSE(dense.pop(now + 3, index));
+
+    // Pushed behind where the scan has got to and already due.
+    ASSERT_TRUE(dense.push(0, now + 1));
+    ASSERT_TRUE(dense.pop(now + 3, index));
+    ASSERT_EQ(index, 0u);
+
+    ASSERT_TRUE(dense.peek(index, time));
+    ASSERT_EQ(index, 4u);
+    ASSERT_EQ(dense.size(), 2u);
+}
@@ -0,0 +1,202 @@
+#if !defined(ARDUINO)
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/executor.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class ExecutorSuite : public ::testing::Test {
+protected:
+
+};
+
+class SlowTask : public PeriodicTask {
+private:
+    std::chrono::milliseconds duration_;
+    std::atomic<uint32_t> runs_{ 0 };
+    std::atomic<uint32_t> running_{ 0 };
+    std::atomic<uint32_t> most_{ 0 };
+
+public:
+    SlowTask(uint32_t interval, uint32_t ms) : PeriodicTask(interval), duration_(ms) {
+    }
+
+public:
+    uint32_t runs() const {
+        return runs_;
+    }
+
+    // Most runs of this task that were ever going at once.
+    uint32_t most() const {
+        return most_;
+    }
+
+    void run() override {
+        auto running = ++running_;
+        auto most = most_.load();
+        while (running > most && !most_.compare_exchange_weak(most, running)) {
+        }
+        std::this_thread::sleep_for(duration_);
+        --running_;
+        ++runs_;
+    }
+};
+
+TEST_F(ExecutorSuite, RunsEveryDueTask) {
+    std::vector<std::unique_ptr<SlowTask>> slow;
+    std::vector<Task*> tasks;
+    for (auto i = 0u; i < 20; ++i) {
+        slow.emplace_back(new SlowTask(1 + i % 3, 0));
+        tasks.push_back(slow.back().get());
+    }
+
+    Scheduler scheduler{ tasks.data(), tasks.size() };
+    Executor executor{ scheduler, 4 };
+    ASSERT_TRUE(executor.start());
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+
+    auto queued = 0u;
+    for (auto i = 0; i < 12; ++i) {
+        queued += executor.check(now);
+        executor.wait();
+        now += 1;
+    }
+    executor.stop();
+
+    auto runs = 0u;
+    for (auto &task : slow) {
+        runs += task->runs();
+        ASSERT_EQ(task->runs(), 12 / task->interval());
+    }
+    ASSERT_EQ(runs, queued);
+    ASSERT_EQ(executor.stats().runs, runs);
+    ASSERT_EQ(executor.stats().skipped, 0u);
+}
+
+TEST_F(ExecutorSuite, SlowTaskDoesNotHoldUpOthers) {
+    SlowTask slow{ 1, 300 };
+    SlowTask fast{ 1, 0 };
+    Task *tasks[] = { &slow, &fast };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 2 };
+    ASSERT_TRUE(executor.start());
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+
+    auto started = std::chrono::steady_clock::now();
+    ASSERT_EQ(executor.check(now), 2u);
+    ASSERT_LT(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(100));
+
+    while (fast.runs() == 0) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(slow.runs(), 0u);
+    executor.wait();
+    ASSERT_EQ(slow.runs(), 1u);
+}
+
+TEST_F(ExecutorSuite, OverlapSkip) {
+    SlowTask task{ 1, 200 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 4, Executor::Overlap::Skip };
+    ASSERT_TRUE(executor.start());
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    for (auto i = 0; i < 3; ++i) {
+        executor.check(now);
+        now += 1;
+    }
+    executor.wait();
+
+    ASSERT_EQ(task.runs(), 1u);
+    ASSERT_EQ(task.most(), 1u);
+    ASSERT_EQ(executor.stats().skipped, 2u);
+}
+
+TEST_F(ExecutorSuite, OverlapCoalesce) {
+    SlowTask task{ 1, 200 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 4, Executor::Overlap::Coalesce };
+    ASSERT_TRUE(executor.start());
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    for (auto i = 0; i < 3; ++i) {
+        executor.check(now);
+        now += 1;
+    }
+    executor.wait();
+
+    ASSERT_EQ(task.runs(), 2u);
+    ASSERT_EQ(task.most(), 1u);
+    ASSERT_EQ(executor.stats().coalesced, 2u);
+}
+
+TEST_F(ExecutorSuite, OverlapCoalesceKeepsRunning) {
+    SlowTask task{ 1, 0 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 2, Executor::Overlap::Coalesce };
+    ASSERT_TRUE(executor.start());
+
+    // Submitting as fast as runs finish, so some land between a run
+    // ending and its worker going idle.
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    for (auto i = 0; i < 1000000; ++i) {
+        executor.check(now);
+        now += 1;
+    }
+    executor.wait();
+
+    auto runs = task.runs();
+    ASSERT_GT(runs, 0u);
+    ASSERT_EQ(executor.check(now), 1u);
+    executor.wait();
+    ASSERT_EQ(task.runs(), runs + 1);
+    ASSERT_EQ(task.most(), 1u);
+}
+
+TEST_F(ExecutorSuite, OverlapAllow) {
+    SlowTask task{ 1, 200 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 4, Executor::Overlap::Allow };
+    ASSERT_TRUE(executor.start());
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    for (auto i = 0; i < 3; ++i) {
+        executor.check(now);
+        now += 1;
+    }
+    executor.wait();
+
+    ASSERT_EQ(task.runs(), 3u);
+    ASSERT_GT(task.most(), 1u);
+}
+
+TEST_F(ExecutorSuite, NoWorkers) {
+    PeriodicTask task{ 1 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    Executor executor{ scheduler, 0 };
+    ASSERT_FALSE(executor.start());
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/expression.h>
+
+using namespace lwcron;
+using namespace lwcron::literals;
+
+class ExpressionSuite : public ::testing::Test {
+protected:
+
+};
+
+static_assert("0 */5 *"_cron == CronSpec::everyFiveMinutes(), "every five minutes");
+static_assert("0 0,20,40 *"_cron == CronSpec::everyTwentyMinutes(), "every twenty minutes");
+static_assert("0 15 6"_cron == CronSpec::specific(0, 15, 6), "6:15AM");
+static_assert("  30   *  *  "_cron == CronSpec::specific(30), "spaces");
+static_assert("* * *"_cron == CronSpec::interval(1), "every second");
+static_assert("0 0 */6"_cron == CronSpec::interval(60 * 60 * 6), "every six hours");
+static_assert("*/5 0-30 9-17"_cron == CronSpec::bits(0x0842108421084210ull >> 4, (1ull << 31) - 1, ((1u << 18) - 1) & ~((1u << 9) - 1)), "range");
+static_assert("10/20 1-10/3,59 23"_cron == CronSpec::bits((1ull << 10) | (1ull << 30) | (1ull << 50), (1ull << 1) | (1ull << 4) | (1ull << 7) | (1ull << 10) | (1ull << 59), 1u << 23), "steps");
+
+TEST_F(ExpressionSuite, RuntimeMatchesCompileTime) {
+    const char *expressions[] = {
+        "0 */5 *",
+        "0 0,20,40 *",
+        "0 15 6",
+        "  30   *  *  ",
+        "* * *",
+        "0 0 */6",
+        "*/5 0-30 9-17",
+        "10/20 1-10/3,59 23",
+        "0-59 0-59 0-23",
+        "59 59 23",
+        "1,2,3,4,5 */7 */23",
+    };
+
+    for (auto expression : expressions) {
+        CronSpec spec;
+        ASSERT_TRUE(CronSpec::parse(expression, spec)) << expression;
+        ASSERT_EQ(spec, expression::parse(expression)) << expression;
+        ASSERT_TRUE(spec.valid()) << expression;
+    }
+}
+
+TEST_F(ExpressionSuite, Malformed) {
+    const char *expressions[] = {
+        "",
+        "0",
+        "0 0",
+        "0 0 0 0",
+        "60 * *",
+        "* 60 *",
+        "* * 24",
+        "*/0 * *",
+        "5-1 * *",
+        "1- * *",
+        "-1 * *",
+        "1,,2 * *",
+        "1, * *",
+        "a * *",
+        "*/ * *",
+        "100 * *",
+        "0 0 0x",
+        "99999999999999999999 * *",
+    };
+
+    for (auto expression : expressions) {
+        auto spec = CronSpec::specific(1, 2, 3);
+        ASSERT_FALSE(CronSpec::parse(expression, spec)) << expression;
+        ASSERT_EQ(spec, CronSpec::specific(1, 2, 3)) << expression;
+        ASSERT_FALSE(expression::parse(expression).valid()) << expression;
+    }
+}
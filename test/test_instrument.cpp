@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+
+#if defined(LWCRON_INSTRUMENT)
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class InstrumentSuite : public ::testing::Test {
+protected:
+
+};
+
+class ToggledTask : public PeriodicTask {
+public:
+    bool on{ true };
+
+public:
+    ToggledTask(uint32_t interval) : PeriodicTask(interval) {
+    }
+
+public:
+    bool enabled() const override {
+        return on;
+    }
+};
+
+class StatsVisitor : public TaskVisitor {
+public:
+    std::vector<std::pair<Task*, TaskStats>> tasks;
+    std::vector<SchedulerStats> schedulers;
+    uint32_t periodic{ 0 };
+
+public:
+    void visit(PeriodicTask &task) override {
+        periodic++;
+    }
+
+    void visit(Task &task, TaskStats const &stats) override {
+        tasks.emplace_back(&task, stats);
+    }
+
+    void visit(Scheduler &scheduler, SchedulerStats const &stats) override {
+        schedulers.push_back(stats);
+    }
+};
+
+TEST_F(InstrumentSuite, HistogramBuckets) {
+    Histogram histogram{ };
+    uint32_t values[] = { 0, 1, 2, 3, 4, 7, 8, 1000, UINT32_MAX };
+    for (auto value : values) {
+        histogram.record(value);
+    }
+    ASSERT_EQ(histogram.counts[0], 1u);
+    ASSERT_EQ(histogram.counts[1], 1u);
+    ASSERT_EQ(histogram.counts[2], 2u);
+    ASSERT_EQ(histogram.counts[3], 2u);
+    ASSERT_EQ(histogram.counts[4], 1u);
+    ASSERT_EQ(histogram.counts[10], 1u);
+    ASSERT_EQ(histogram.counts[Histogram::Buckets - 1], 1u);
+    ASSERT_EQ(histogram.total(), 9u);
+}
+
+TEST_F(InstrumentSuite, LatenessSkipsAndRuns) {
+    auto simulate = [](Scheduler &scheduler, ToggledTask &every10) {
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+
+        // On time twice.
+        while (scheduler.check(now)) {
+        }
+        now += 10;
+        while (scheduler.check(now)) {
+        }
+
+        // 15 seconds late, passing over one of its times.
+        now += 25;
+        while (scheduler.check(now)) {
+        }
+
+        auto &stats = every10.stats();
+        ASSERT_EQ(stats.runs, 3u);
+        ASSERT_EQ(stats.lateness.counts[0], 2u);
+        ASSERT_EQ(stats.lateness.counts[4], 1u);
+        ASSERT_EQ(stats.duration.total(), 3u);
+        ASSERT_EQ(stats.skipped, 1u);
+        ASSERT_EQ(stats.overruns, 0u);
+        ASSERT_EQ(scheduler.stats().checks, 6u);
+    };
+
+    {
+        ToggledTask every10{ 10 };
+        Task *tasks[] = { &every10 };
+        Scheduler scheduler{ tasks };
+        simulate(scheduler, every10);
+    }
+    {
+        ToggledTask every10{ 10 };
+        Task *tasks[] = { &every10 };
+        HeapQueue::Slot slots[1];
+        HeapQueue queue{ slots };
+        Scheduler scheduler{ tasks, queue };
+        simulate(scheduler, every10);
+
+        // Queued and disabled when due, dropped like scanning skips it
+        // and not counted.
+        every10.on = false;
+        ASSERT_FALSE(scheduler.check(JacobsBirth + 40));
+        ASSERT_FALSE(scheduler.nextTask());
+        ASSERT_EQ(every10.stats().skipped, 1u);
+        ASSERT_EQ(every10.stats().runs, 3u);
+    }
+}
+
+TEST_F(InstrumentSuite, RebeginsAndVisiting) {
+    ToggledTask task1{ 150 };
+    ToggledTask task2{ 60 };
+    Task *tasks[] = { &task1, &task2 };
+    Scheduler scheduler{ tasks };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    ASSERT_TRUE(scheduler.check(now));
+
+    // A few seconds back isn't counted, hours back is.
+    ASSERT_FALSE(scheduler.check(now - 10));
+    ASSERT_EQ(scheduler.stats().rebegins, 0u);
+    ASSERT_FALSE(scheduler.check(now - 60 * 60 * 2));
+    ASSERT_EQ(scheduler.stats().rebegins, 1u);
+    ASSERT_EQ(scheduler.stats().rewound_from, now.unix_time() - 10);
+    ASSERT_EQ(scheduler.stats().rewound_to, now.unix_time() - 60 * 60 * 2);
+
+    StatsVisitor visitor;
+    scheduler.accept(visitor);
+    ASSERT_EQ(visitor.periodic, 2u);
+    ASSERT_EQ(visitor.tasks.size(), 2u);
+    ASSERT_EQ(visitor.tasks[0].first, &task1);
+    ASSERT_EQ(visitor.tasks[0].second.runs, 1u);
+    ASSERT_EQ(visitor.tasks[1].first, &task2);
+    ASSERT_EQ(visitor.tasks[1].second.runs, 0u);
+    ASSERT_EQ(visitor.schedulers.size(), 1u);
+    ASSERT_EQ(visitor.schedulers[0].checks, 3u);
+    ASSERT_EQ(visitor.schedulers[0].rebegins, 1u);
+}
+
+#endif
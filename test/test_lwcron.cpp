@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <vector>
 
 #include <lwcron/lwcron.h>
@@ -17,6 +18,66 @@ TEST_F(SchedulerSuite, DateTime) {
     ASSERT_EQ(DateTime{ 388395000 }, JacobsBirth);
 }
 
+TEST_F(SchedulerSuite, DateTimeRoundTripsEveryDay) {
+    auto is_leap_year = [](uint32_t year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    };
+    uint8_t days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    // Walk the calendar one day at a time across the whole range of a
+    // uint32_t, from 1970-01-01 until 2106-02-07 06:28:15.
+    uint16_t year = 1970;
+    uint8_t month = 1;
+    uint8_t day = 1;
+    for (auto days = 0u; days <= UINT32_MAX / 86400; ++days) {
+        auto seconds_into_day = (days * 7919u) % 86400;
+        auto unix_time = days * 86400u + seconds_into_day;
+        if (days == UINT32_MAX / 86400) {
+            unix_time = UINT32_MAX;
+        }
+
+        DateTime dt{ unix_time };
+        ASSERT_EQ(dt.year(), year);
+        ASSERT_EQ(dt.month(), month);
+        ASSERT_EQ(dt.day(), day);
+        ASSERT_EQ(dt.hour() * 3600 + dt.minute() * 60 + dt.second(), unix_time % 86400);
+
+        DateTime fields{ year, month, day, dt.hour(), dt.minute(), dt.second() };
+        ASSERT_EQ(fields.unix_time(), unix_time);
+
+        auto length = (month == 2 && is_leap_year(year)) ? 29 : days_in_month[month - 1];
+        if (++day > length) {
+            day = 1;
+            if (++month > 12) {
+                month = 1;
+                year++;
+            }
+        }
+    }
+
+    ASSERT_EQ(DateTime(2100, 3, 1, 0, 0, 0).unix_time() - 86400, DateTime(2100, 2, 28, 0, 0, 0).unix_time());
+    ASSERT_EQ(DateTime(2000, 3, 1, 0, 0, 0).unix_time() - 86400, DateTime(2000, 2, 29, 0, 0, 0).unix_time());
+}
+
+TEST_F(SchedulerSuite, DateTimeArithmetic) {
+    auto dt = JacobsBirth;
+    ASSERT_EQ(dt.hour(), 7);
+
+    dt += 60 * 60 * 17;
+    ASSERT_EQ(dt.unix_time(), JacobsBirth.unix_time() + 60 * 60 * 17);
+    ASSERT_EQ(dt.day(), 24);
+    ASSERT_EQ(dt.hour(), 0);
+    ASSERT_EQ(dt.minute(), 30);
+
+    dt -= 60 * 31;
+    ASSERT_EQ(dt.day(), 23);
+    ASSERT_EQ(dt.hour(), 23);
+    ASSERT_EQ(dt.minute(), 59);
+
+    ASSERT_EQ(JacobsBirth + 60 - 60, JacobsBirth);
+    ASSERT_NE(JacobsBirth + 1, JacobsBirth);
+}
+
 TEST_F(SchedulerSuite, Empty) {
     Scheduler scheduler;
 
@@ -415,3 +476,670 @@ TEST_F(SchedulerSuite, ClockMovingBackwardsAFewSecondsDoesNotReRun) {
     auto n2 = scheduler.nextTask();
     ASSERT_EQ(n2.time, n1.time);
 }
+
+TEST_F(SchedulerSuite, BitArrays) {
+    uint64_t word = 0;
+    ASSERT_EQ(bitarray_next(word, 0), -1);
+    ASSERT_FALSE(bitarray_any(word));
+    for (auto i = 0u; i < 64; ++i) {
+        bitarray_set(word, 63 - i);
+        ASSERT_EQ(bitarray_nset(word), i + 1);
+        ASSERT_EQ(bitarray_next(word, 0), (int32_t)(63 - i));
+        ASSERT_EQ(bits_ctz((uint64_t)1 << i), i);
+        ASSERT_EQ(bits_ctz(~(uint64_t)0 << i), i);
+        bitarray_clear(word, 63 - i);
+        bitarray_set(word, 63 - i);
+    }
+
+    uint32_t hours = 0;
+    bitarray_set(hours, 3);
+    bitarray_set(hours, 23);
+    ASSERT_EQ(bitarray_nset(hours), 2u);
+    ASSERT_EQ(bitarray_next(hours, 0, 24), 3);
+    ASSERT_EQ(bitarray_next(hours, 4, 24), 23);
+    ASSERT_EQ(bitarray_next(hours, 4, 23), -1);
+    ASSERT_EQ(bitarray_next(hours, 24, 24), -1);
+    ASSERT_EQ(bits_popcount(0xf0f0f0f0u), 16u);
+    ASSERT_EQ(bits_popcount(~(uint64_t)0), 64u);
+
+    bitarray_clear_set(hours, 5);
+    ASSERT_EQ(hours, 1u << 5);
+    ASSERT_TRUE(bitarray_any(hours));
+    ASSERT_TRUE(bitarray_test(hours, 5));
+    ASSERT_FALSE(bitarray_test(hours, 3));
+}
+
+TEST_F(SchedulerSuite, CronSpecNextTimeMatchesReference) {
+    std::vector<CronSpec> specs = {
+        CronSpec::interval(1),
+        CronSpec::interval(60),
+        CronSpec::interval(60 * 7),
+        CronSpec::interval(86400),
+        CronSpec::specific(0, 30),
+        CronSpec::specific(30, 0, 12),
+        CronSpec::specific(59, 59, 23),
+        CronSpec::everyFiveMinutes(),
+        CronSpec::everyTwentyMinutes(),
+    };
+
+    uint32_t random = 1982;
+    auto next_random = [&](uint32_t n) {
+        random = random * 1103515245 + 12345;
+        return (random >> 8) % n;
+    };
+
+    for (auto i = 0; i < 200; ++i) {
+        CronSpec spec;
+        for (auto j = next_random(4); j < 4; ++j) {
+            bitarray_set(spec.seconds, next_random(60));
+            bitarray_set(spec.minutes, next_random(60));
+            bitarray_set(spec.hours, next_random(24));
+        }
+        specs.push_back(spec);
+    }
+
+    for (auto &spec : specs) {
+        for (auto i = 0; i < 20; ++i) {
+            auto after = JacobsBirth + next_random(86400 * 2);
+            ASSERT_EQ(spec.getNextTime(after), spec.getNextTimeReference(after));
+        }
+    }
+}
+
+TEST_F(SchedulerSuite, HeapQueueRunningTasksMultipleIntervalsDoesntMissTask) {
+    PeriodicTask task1{ 60 * 2 };
+    PeriodicTask task2{ 60 * 2 };
+    Task *tasks[2] = { &task1, &task2 };
+    HeapQueue::Slot slots[2];
+    HeapQueue queue{ slots };
+    Scheduler scheduler{ tasks, queue };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now + 5);
+
+    ASSERT_FALSE(scheduler.check(now + 5));
+    auto n1 = scheduler.nextTask();
+    ASSERT_EQ(n1.task, &task1);
+    ASSERT_EQ(n1.time, now.unix_time() + 60 * 2);
+
+    auto o1 = scheduler.check(now + 60 * 2);
+    ASSERT_EQ(o1.task, &task1);
+
+    auto n2 = scheduler.nextTask();
+    ASSERT_EQ(n2.task, &task2);
+    ASSERT_EQ(n2.time, now.unix_time() + 60 * 2);
+
+    auto o2 = scheduler.check(now + 60 * 3);
+    ASSERT_EQ(o2.task, &task2);
+    ASSERT_FALSE(scheduler.check(now + 60 * 3));
+
+    auto n3 = scheduler.nextTask();
+    ASSERT_EQ(n3.task, &task1);
+    ASSERT_EQ(n3.time, now.unix_time() + 60 * 4);
+}
+
+TEST_F(SchedulerSuite, HeapQueueClockMovingBackwardsResets) {
+    PeriodicTask task1{ 150 };
+    Task *tasks[1] = { &task1 };
+    HeapQueue::Slot slots[1];
+    HeapQueue queue{ slots };
+    Scheduler scheduler{ tasks, queue };
+
+    auto now = JacobsBirth - 1;
+    scheduler.begin(now);
+
+    ASSERT_FALSE(scheduler.check(now));
+
+    now += 1;
+    ASSERT_TRUE(scheduler.check(now));
+    ASSERT_EQ(scheduler.nextTask().time, now.unix_time() + 150);
+
+    now -= 60 * 60 * 2 + 1;
+    ASSERT_FALSE(scheduler.check(now));
+    ASSERT_EQ(scheduler.nextTask().time, now.unix_time() + 1);
+    ASSERT_TRUE(scheduler.check(now + 1));
+}
+
+TEST_F(SchedulerSuite, HeapQueueRunsTasksInTheSameOrderAsScanning) {
+    std::vector<PeriodicTask> periodic;
+    std::vector<CronTask> cron;
+    for (auto i = 0u; i < 20; ++i) {
+        periodic.emplace_back(30 + i * 15);
+        cron.emplace_back(CronSpec::specific(i * 3, 0xff, 0xff));
+    }
+    cron.emplace_back(CronSpec{ });
+
+    std::vector<Task*> tasks;
+    for (auto i = 0u; i < cron.size(); ++i) {
+        if (i < periodic.size()) {
+            tasks.push_back(&periodic[i]);
+        }
+        tasks.push_back(&cron[i]);
+    }
+
+    std::vector<HeapQueue::Slot> slots(tasks.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    Scheduler scanning{ tasks.data(), tasks.size() };
+    Scheduler queued{ tasks.data(), tasks.size(), queue };
+
+    auto simulate = [&](Scheduler &scheduler) {
+        std::vector<std::pair<uint32_t, Task*>> fired;
+        scheduler.begin(JacobsBirth);
+        for (auto now = JacobsBirth; now != JacobsBirth + 60 * 60; now += 1) {
+            while (auto tt = scheduler.check(now)) {
+                fired.emplace_back(tt.time, tt.task);
+            }
+        }
+        return fired;
+    };
+
+    auto expected = simulate(scanning);
+    ASSERT_EQ(simulate(queued), expected);
+    ASSERT_GT(expected.size(), 1000u);
+}
+
+class CountingTask : public PeriodicTask {
+private:
+    uint32_t runs_{ 0 };
+
+public:
+    CountingTask(uint32_t interval) : PeriodicTask(interval) {
+    }
+
+public:
+    uint32_t runs() const {
+        return runs_;
+    }
+
+public:
+    void run() override {
+        runs_++;
+    }
+};
+
+TEST_F(SchedulerSuite, CheckAllDueTasks) {
+    CountingTask task1{ 60 * 2 };
+    CountingTask task2{ 60 * 3 };
+    CountingTask task3{ 60 * 2 };
+    Task *tasks[3] = { &task1, &task2, &task3 };
+    Scheduler scheduler{ tasks };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now + 5);
+
+    Scheduler::TaskAndTime due[3];
+    ASSERT_EQ(scheduler.check(now + 5, due), 0u);
+
+    ASSERT_EQ(scheduler.check(now + 60 * 2, due), 2u);
+    ASSERT_EQ(due[0].task, &task1);
+    ASSERT_EQ(due[1].task, &task3);
+    ASSERT_EQ(due[1].time, now.unix_time() + 60 * 2);
+    ASSERT_EQ(task1.runs(), 1u);
+    ASSERT_EQ(task2.runs(), 0u);
+    ASSERT_EQ(task3.runs(), 1u);
+    ASSERT_EQ(scheduler.check(now + 60 * 2, due), 0u);
+
+    // Three due at 6 minutes, with room for two. The last stays due.
+    ASSERT_EQ(scheduler.check(now + 60 * 6, &due[0], 2), 2u);
+    ASSERT_EQ(due[0].task, &task1);
+    ASSERT_EQ(due[1].task, &task2);
+    ASSERT_EQ(scheduler.check(now + 60 * 6, due), 1u);
+    ASSERT_EQ(due[0].task, &task3);
+
+    // Collecting reschedules without running.
+    ASSERT_EQ(scheduler.check(now + 60 * 8, due, 0, Scheduler::Dispatch::Collect), 2u);
+    ASSERT_EQ(task1.runs(), 2u);
+    ASSERT_EQ(task3.runs(), 2u);
+    ASSERT_EQ(scheduler.nextTask().time, now.unix_time() + 60 * 9);
+}
+
+TEST_F(SchedulerSuite, CheckAllDueTasksClockMovingBackwardsResets) {
+    CountingTask task1{ 150 };
+    HeapQueue::Slot slots[1];
+    HeapQueue queue{ slots };
+    Task *tasks[1] = { &task1 };
+    Scheduler scheduler{ tasks, queue };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+
+    Scheduler::TaskAndTime due[1];
+    ASSERT_EQ(scheduler.check(now, due), 1u);
+
+    now -= 60 * 60 * 2;
+    ASSERT_EQ(scheduler.check(now, due), 0u);
+    ASSERT_EQ(scheduler.nextTask().time, now.unix_time());
+    ASSERT_EQ(task1.runs(), 1u);
+}
+
+static constexpr CronSpec Hourly = CronSpec::interval(60 * 60);
+static constexpr CronSpec EverySecond = CronSpec::interval(1);
+static constexpr CronSpec EveryNinetySeconds = CronSpec::interval(90);
+static constexpr CronSpec SixFifteenAm = CronSpec::specific(0, 15, 6);
+
+static_assert(Hourly.seconds == 1 && Hourly.minutes == 1 && Hourly.hours == CronSpec::AllHours, "hourly");
+static_assert(EverySecond.seconds == CronSpec::AllSeconds && EverySecond.minutes == CronSpec::AllMinutes, "every second");
+static_assert(EveryNinetySeconds.seconds == ((1ull << 0) | (1ull << 30)), "every ninety seconds");
+static_assert(CronSpec::interval(60 * 60 * 6).hours == ((1u << 0) | (1u << 6) | (1u << 12) | (1u << 18)), "every six hours");
+static_assert(CronSpec::interval(0).seconds == 0 && CronSpec::interval(0).hours == 0, "never");
+static_assert(SixFifteenAm.seconds == 1 && SixFifteenAm.minutes == (1ull << 15) && SixFifteenAm.hours == (1u << 6), "6:15AM");
+static_assert(CronSpec::specific(30).minutes == CronSpec::AllMinutes, "every minute");
+static_assert(CronSpec::everyTwentyMinutes().minutes == ((1ull << 0) | (1ull << 20) | (1ull << 40)), "every twenty minutes");
+static_assert(CronSpec::everyFiveMinutes().minutes == 0x084210842108421ull, "every five minutes");
+static_assert(CronSpec(TimeOfDay{ 7 * 3600 + 30 * 60 + 5 }) == CronSpec(7, 30, 5), "time of day");
+
+// Built entirely at compile time, no static initializers.
+static CronTask ConstantTasks[] = { CronTask{ Hourly }, CronTask{ SixFifteenAm, 30 } };
+
+TEST_F(SchedulerSuite, CronSpecIntervalMatchesStepping) {
+    for (auto seconds = 1u; seconds <= SecondsPerDay + 1; ++seconds) {
+        CronSpec expected;
+        for (auto s = 0u; s <= SecondsPerDay; s += seconds) {
+            expected.set(TimeOfDay{ s });
+        }
+        ASSERT_EQ(CronSpec::interval(seconds), expected) << seconds;
+    }
+
+    ASSERT_EQ(ConstantTasks[1].spec(), SixFifteenAm);
+}
+
+TEST_F(SchedulerSuite, SecondsUntilNextTask) {
+    PeriodicTask task1{ 60 * 60 * 2 };
+    CronTask task2{ CronSpec::specific(30, 31), 20 };
+    Task *tasks[2] = { &task1, &task2 };
+    Scheduler scheduler{ tasks };
+
+    Scheduler empty;
+    ASSERT_EQ(empty.secondsUntilNextTask(JacobsBirth), UINT32_MAX);
+
+    auto now = JacobsBirth + 5;
+    scheduler.begin(now);
+    ASSERT_EQ(scheduler.secondsUntilNextTask(now), 85u);
+    ASSERT_EQ(scheduler.secondsUntilNextTask(now + 85), 0u);
+    ASSERT_EQ(scheduler.secondsUntilNextTask(now + 100), 0u);
+
+    ASSERT_EQ(scheduler.check(now + 85, 7).task, &task2);
+    ASSERT_EQ(scheduler.secondsUntilNextTask(now + 85), 60u * 28 + 30);
+
+    // The jitter picked when task2 ran pushes back its next wakeup.
+    DateTime eight{ 1982, 4, 23, 8, 0, 0 };
+    ASSERT_EQ(scheduler.check(eight, 7).task, &task1);
+    ASSERT_EQ(scheduler.nextTask().task, &task2);
+    ASSERT_EQ(scheduler.secondsUntilNextTask(eight), 60u * 31 + 30 + 7);
+}
+
+class SwitchedTask : public CountingTask {
+private:
+    bool enabled_{ true };
+
+public:
+    SwitchedTask(uint32_t interval) : CountingTask(interval) {
+    }
+
+public:
+    void enable(bool enabled) {
+        enabled_ = enabled;
+    }
+
+    bool enabled() const override {
+        return enabled_;
+    }
+};
+
+// Sleeps until the next task is due on a virtual clock, rather than
+// checking every second, and should wake up once per distinct time tasks
+// run at. Never for the disabled one.
+template<typename Setup>
+static void simulate_tickless(Setup setup) {
+    PeriodicTask task1{ 7 };
+    PeriodicTask task2{ 60 * 11 };
+    CronTask task3{ CronSpec::everyFiveMinutes(), 30 };
+    CronTask task4{ CronSpec::specific(15, 45, 3) };
+    SwitchedTask disabled{ 10 };
+    disabled.enable(false);
+    Task *tasks[5] = { &task1, &task2, &task3, &task4, &disabled };
+
+    auto start = JacobsBirth + 3;
+    auto end = start + 86400;
+    std::vector<std::pair<uint32_t, Task*>> polled;
+    std::vector<std::pair<uint32_t, Task*>> slept;
+
+    {
+        HeapQueue::Slot slots[5];
+        HeapQueue queue{ slots };
+        auto scheduler = setup(tasks, queue);
+        scheduler.begin(start);
+        for (auto now = start; now.unix_time() < end.unix_time(); now += 1) {
+            while (auto tt = scheduler.check(now, now.unix_time())) {
+                polled.emplace_back(tt.time, tt.task);
+            }
+        }
+    }
+
+    auto wakeups = 0u;
+    auto distinct = 0u;
+    {
+        HeapQueue::Slot slots[5];
+        HeapQueue queue{ slots };
+        auto scheduler = setup(tasks, queue);
+        scheduler.begin(start);
+        for (auto now = start; now.unix_time() < end.unix_time(); ) {
+            wakeups++;
+            auto before = slept.size();
+            while (auto tt = scheduler.check(now, now.unix_time())) {
+                slept.emplace_back(tt.time, tt.task);
+            }
+            if (slept.size() > before) {
+                distinct++;
+            }
+            now += scheduler.secondsUntilNextTask(now);
+        }
+    }
+
+    // Less the first wakeup, when nothing might be due.
+    ASSERT_EQ(slept, polled);
+    ASSERT_LE(wakeups, distinct + 1);
+    ASSERT_GT(wakeups, 86400u / 7);
+    ASSERT_LT(wakeups, 86400u / 6);
+    ASSERT_EQ(disabled.runs(), 0u);
+}
+
+TEST_F(SchedulerSuite, TicklessWakeupsMatchFirings) {
+    simulate_tickless([](Task *(&tasks)[5], HeapQueue &) {
+        return Scheduler{ tasks };
+    });
+    simulate_tickless([](Task *(&tasks)[5], HeapQueue &queue) {
+        return Scheduler{ tasks, queue };
+    });
+}
+
+TEST_F(SchedulerSuite, AddRemoveAndRefreshTasks) {
+    auto simulate = [](Scheduler &scheduler) {
+        SwitchedTask every10{ 10 };
+        SwitchedTask every15{ 15 };
+        SwitchedTask every20{ 20 };
+        SwitchedTask every30{ 30 };
+
+        auto run = [&](DateTime &now, uint32_t seconds) {
+            for (auto i = 0u; i < seconds; ++i) {
+                while (scheduler.check(now)) {
+                }
+                now += 1;
+            }
+        };
+
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+        ASSERT_FALSE(scheduler.nextTask());
+
+        ASSERT_TRUE(scheduler.add(&every10, now));
+        ASSERT_TRUE(scheduler.add(&every15, now));
+        ASSERT_TRUE(scheduler.add(&every20, now));
+        ASSERT_FALSE(scheduler.add(&every30, now));
+        ASSERT_EQ(scheduler.size(), 3u);
+
+        run(now, 60);
+        ASSERT_EQ(every10.runs(), 6u);
+        ASSERT_EQ(every15.runs(), 4u);
+        ASSERT_EQ(every20.runs(), 3u);
+
+        // The last task takes the removed one's place.
+        ASSERT_TRUE(scheduler.remove(&every10));
+        ASSERT_FALSE(scheduler.remove(&every10));
+        ASSERT_EQ(scheduler.size(), 2u);
+        ASSERT_EQ(scheduler[0], &every20);
+        ASSERT_TRUE(scheduler.add(&every30, now));
+
+        run(now, 60);
+        ASSERT_EQ(every10.runs(), 6u);
+        ASSERT_EQ(every15.runs(), 8u);
+        ASSERT_EQ(every20.runs(), 6u);
+        ASSERT_EQ(every30.runs(), 2u);
+
+        every15.enable(false);
+        ASSERT_TRUE(scheduler.refresh(&every15, now));
+        ASSERT_EQ(scheduler.nextTask().task, &every20);
+        run(now, 60);
+        ASSERT_EQ(every15.runs(), 8u);
+
+        every15.enable(true);
+        ASSERT_TRUE(scheduler.refresh(&every15, now));
+        ASSERT_FALSE(scheduler.refresh(&every10, now));
+        run(now, 60);
+        ASSERT_EQ(every15.runs(), 12u);
+        ASSERT_EQ(every20.runs(), 12u);
+        ASSERT_EQ(every30.runs(), 6u);
+    };
+
+    {
+        Task *tasks[3];
+        Scheduler scheduler{ tasks, 0, 3 };
+        simulate(scheduler);
+    }
+    {
+        Task *tasks[3];
+        HeapQueue::Slot slots[3];
+        HeapQueue queue{ slots };
+        Scheduler scheduler{ tasks, 0, 3, queue };
+        simulate(scheduler);
+    }
+    {
+        Task *tasks[3];
+        uint32_t bits[1];
+        Scheduler scheduler{ tasks, 0, 3 };
+        ASSERT_TRUE(scheduler.cache(bits));
+        simulate(scheduler);
+    }
+    {
+        Task *tasks[3];
+        HeapQueue::Slot slots[3];
+        HeapQueue queue{ slots };
+        uint32_t bits[1];
+        Scheduler scheduler{ tasks, 0, 3, queue };
+        ASSERT_TRUE(scheduler.cache(bits));
+        simulate(scheduler);
+    }
+}
+
+class AskedTask : public SwitchedTask {
+public:
+    mutable uint32_t asked{ 0 };
+
+public:
+    AskedTask(uint32_t interval) : SwitchedTask(interval) {
+    }
+
+public:
+    bool valid() const override {
+        asked++;
+        return SwitchedTask::valid();
+    }
+};
+
+TEST_F(SchedulerSuite, CachedActiveTasksAreOnlyAskedOnRefresh) {
+    std::vector<AskedTask> cached_tasks;
+    std::vector<AskedTask> plain_tasks;
+    for (auto i = 0u; i < 70; ++i) {
+        cached_tasks.emplace_back(i % 4 == 0 ? 0 : 5 + i);
+        plain_tasks.emplace_back(i % 4 == 0 ? 0 : 5 + i);
+    }
+
+    std::vector<Task*> cached_pointers;
+    std::vector<Task*> plain_pointers;
+    for (auto i = 0u; i < 70; ++i) {
+        cached_pointers.push_back(&cached_tasks[i]);
+        plain_pointers.push_back(&plain_tasks[i]);
+    }
+
+    uint32_t bits[3];
+    Scheduler cached{ cached_pointers.data(), cached_pointers.size() };
+    Scheduler plain{ plain_pointers.data(), plain_pointers.size() };
+    ASSERT_FALSE(cached.cache(bits, 2));
+    ASSERT_TRUE(cached.cache(bits));
+
+    auto now = JacobsBirth;
+    cached.begin(now);
+    plain.begin(now);
+
+    auto check = [&](Scheduler &scheduler, std::vector<Task*> &pointers) {
+        std::vector<size_t> fired;
+        while (auto tt = scheduler.check(now)) {
+            fired.push_back(std::find(pointers.begin(), pointers.end(), tt.task) - pointers.begin());
+        }
+        return fired;
+    };
+
+    for (auto i = 0u; i < 600; ++i) {
+        if (i == 300) {
+            cached_tasks[65].enable(false);
+            plain_tasks[65].enable(false);
+            ASSERT_TRUE(cached.refresh(&cached_tasks[65], now));
+        }
+        ASSERT_EQ(check(cached, cached_pointers), check(plain, plain_pointers));
+        ASSERT_EQ(cached.nextTask().time, plain.nextTask().time);
+        now += 1;
+    }
+
+    // When cached, at begin and once when refreshed.
+    for (auto i = 0u; i < 70; ++i) {
+        ASSERT_EQ(cached_tasks[i].asked, i == 65 ? 3u : 2u);
+        ASSERT_GT(plain_tasks[i].asked, 600u);
+    }
+}
+
+TEST_F(SchedulerSuite, CacheTakesEffectStraightAway) {
+    CountingTask every10{ 10 };
+    SwitchedTask every15{ 15 };
+    CountingTask never{ 0 };
+    Task *tasks[3] = { &every10, &every15, &never };
+    Scheduler scheduler{ tasks };
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    every15.enable(false);
+
+    // Garbage in the bits beforehand, and no begin after.
+    uint32_t bits[1] = { UINT32_MAX };
+    ASSERT_TRUE(scheduler.cache(bits));
+    ASSERT_EQ(bits[0], 1u);
+    ASSERT_EQ(scheduler.nextTask().task, &every10);
+
+    Scheduler::TaskAndTime due[3];
+    ASSERT_EQ(scheduler.check(now, due), 1u);
+    ASSERT_EQ(due[0].task, &every10);
+    ASSERT_EQ(every15.runs(), 0u);
+}
+
+TEST_F(SchedulerSuite, HeapQueueRemoveAndMove) {
+    HeapQueue::Slot slots[8];
+    HeapQueue queue{ slots };
+
+    uint32_t times[] = { 50, 10, 40, 20, 30, 10 };
+    for (auto i = 0u; i < 6; ++i) {
+        ASSERT_TRUE(queue.push(i, times[i]));
+    }
+    ASSERT_FALSE(queue.push(8, 0));
+
+    ASSERT_TRUE(queue.remove(3));
+    ASSERT_FALSE(queue.remove(3));
+    ASSERT_FALSE(queue.remove(7));
+    ASSERT_TRUE(queue.move(1, 7));
+    ASSERT_FALSE(queue.move(1, 6));
+    ASSERT_FALSE(queue.move(5, 7));
+    // Pushing something already queued moves it.
+    ASSERT_TRUE(queue.push(0, 5));
+    ASSERT_EQ(queue.size(), 5u);
+
+    uint32_t index;
+    uint32_t expected[] = { 0, 5, 7, 4, 2 };
+    for (auto i : expected) {
+        ASSERT_TRUE(queue.pop(100, index));
+        ASSERT_EQ(index, i);
+    }
+    ASSERT_FALSE(queue.pop(100, index));
+}
+
+TEST_F(SchedulerSuite, NextTimeFromMatchesRecomputing) {
+    std::vector<PeriodicTask> periodic;
+    std::vector<CronTask> cron;
+    for (auto interval : { 1u, 7u, 60u, 97u, 3600u }) {
+        periodic.emplace_back(interval);
+    }
+    for (auto interval : { 1u, 5u, 7u, 90u, 7200u }) {
+        cron.emplace_back(CronSpec::interval(interval));
+    }
+    cron.emplace_back(CronSpec::specific(15, 45));
+    cron.emplace_back(CronSpec::specific(0, 0, 3));
+    cron.emplace_back(CronSpec::everyTwentyMinutes(), 30);
+
+    std::vector<Task*> tasks;
+    for (auto &task : periodic) {
+        tasks.push_back(&task);
+    }
+    for (auto &task : cron) {
+        tasks.push_back(&task);
+    }
+
+    // Late by varying amounts, including some that are later than the
+    // next time.
+    for (auto task : tasks) {
+        for (auto seed : { 0u, 12345u }) {
+            auto previous = task->getNextTime(JacobsBirth, seed);
+            for (auto i = 0u; i < 2000; ++i) {
+                auto after = DateTime{ previous + 1 + (i * 7919) % (i % 5 == 0 ? 9000 : 3) };
+                auto expected = task->getNextTime(after, seed);
+                ASSERT_EQ(task->getNextTimeFrom(previous, after, seed), expected);
+                previous = expected;
+            }
+        }
+    }
+}
+
+TEST_F(SchedulerSuite, CronSpecPoolWorksEachSpecOutOncePerTick) {
+    CronSpecPool::Entry entries[2];
+    CronSpecPool pool{ entries };
+
+    std::vector<PooledCronTask> pooled;
+    std::vector<CronTask> plain;
+    for (auto i = 0u; i < 50; ++i) {
+        auto spec = i % 2 == 0 ? CronSpec::everyFiveMinutes() : CronSpec::specific(30);
+        pooled.emplace_back(pool, spec, i % 3 == 0 ? 20 : 0);
+        plain.emplace_back(spec, i % 3 == 0 ? 20 : 0);
+    }
+    // No room for this one, it works its own times out.
+    pooled.emplace_back(pool, CronSpec::specific(0, 0, 3));
+    plain.emplace_back(CronSpec::specific(0, 0, 3));
+    ASSERT_EQ(pool.size(), 2u);
+
+    std::vector<Task*> pooled_tasks;
+    std::vector<Task*> plain_tasks;
+    for (auto i = (size_t)0; i < pooled.size(); ++i) {
+        pooled_tasks.push_back(&pooled[i]);
+        plain_tasks.push_back(&plain[i]);
+    }
+
+    auto simulate = [](std::vector<Task*> &tasks) {
+        std::vector<std::pair<uint32_t, size_t>> fired;
+        Scheduler scheduler{ tasks.data(), tasks.size() };
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+        for (auto i = 0; i < 60 * 60 * 4; ++i) {
+            Scheduler::TaskAndTime due[64];
+            auto n = scheduler.check(now, due, now.unix_time());
+            for (auto j = (size_t)0; j < n; ++j) {
+                fired.emplace_back(due[j].time, std::find(tasks.begin(), tasks.end(), due[j].task) - tasks.begin());
+            }
+            now += 1;
+        }
+        return fired;
+    };
+
+    auto misses = pool.misses();
+    ASSERT_EQ(simulate(pooled_tasks), simulate(plain_tasks));
+
+    // Twice for begin, then at most once for each spec in a tick where
+    // something ran.
+    auto ticks = 4 * 60 / 5 + 4 * 60;
+    ASSERT_LE(pool.misses() - misses, 2u + ticks * 2);
+    ASSERT_GE(pool.misses() - misses, 2u + ticks);
+}
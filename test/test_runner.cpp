@@ -0,0 +1,81 @@
+#if defined(__linux__)
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/runner.h>
+
+using namespace lwcron;
+
+class LinuxRunnerSuite : public ::testing::Test {
+protected:
+
+};
+
+class StoppingTask : public PeriodicTask {
+private:
+    LinuxRunner *runner_{ nullptr };
+    uint32_t runs_{ 0 };
+    uint32_t stop_after_;
+
+public:
+    StoppingTask(uint32_t interval, uint32_t stop_after) : PeriodicTask(interval), stop_after_(stop_after) {
+    }
+
+public:
+    void runner(LinuxRunner &runner) {
+        runner_ = &runner;
+    }
+
+    uint32_t runs() const {
+        return runs_;
+    }
+
+    void run() override {
+        if (++runs_ == stop_after_) {
+            runner_->stop();
+        }
+    }
+};
+
+TEST_F(LinuxRunnerSuite, RunsTasksOnTime) {
+    StoppingTask task{ 1, 2 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    LinuxRunner runner{ scheduler };
+    task.runner(runner);
+
+    ASSERT_TRUE(runner.open());
+
+    auto started = time(nullptr);
+    runner.run();
+
+    // Runs straight away, then again as the next second begins.
+    ASSERT_EQ(task.runs(), 2u);
+    ASSERT_LE(time(nullptr) - started, 2);
+}
+
+TEST_F(LinuxRunnerSuite, StopFromAnotherThread) {
+    PeriodicTask task{ 60 * 60 };
+    Task *tasks[] = { &task };
+    Scheduler scheduler{ tasks };
+    LinuxRunner runner{ scheduler };
+
+    ASSERT_TRUE(runner.open());
+
+    auto started = std::chrono::steady_clock::now();
+    std::thread stopper{ [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        runner.stop();
+    } };
+    runner.run();
+    stopper.join();
+
+    ASSERT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(1));
+    ASSERT_FALSE(runner.poll(0));
+}
+
+#endif
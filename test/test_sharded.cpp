@@ -0,0 +1,211 @@
+#if !defined(ARDUINO)
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/sharded.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class ShardedSchedulerSuite : public ::testing::Test {
+protected:
+
+};
+
+class RecordingTask : public PeriodicTask {
+private:
+    std::atomic<uint32_t> runs_{ 0 };
+
+public:
+    RecordingTask(uint32_t interval) : PeriodicTask(interval) {
+    }
+
+public:
+    uint32_t runs() const {
+        return runs_;
+    }
+
+    void run() override {
+        ++runs_;
+    }
+};
+
+TEST_F(ShardedSchedulerSuite, RunsTheSameTasksAsOneScheduler) {
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (auto i = 0u; i < 200; ++i) {
+        tasks.emplace_back(new RecordingTask(3 + i % 47));
+    }
+
+    ShardedScheduler sharded{ 4 };
+    auto now = JacobsBirth;
+    for (auto &task : tasks) {
+        sharded.add(task.get(), now);
+    }
+    ASSERT_EQ(sharded.stats().tasks, 200u);
+
+    sharded.begin(now);
+
+    auto expected = 0u;
+    for (auto i = 0; i < 600; ++i) {
+        auto ran = 0u;
+        for (auto s = (size_t)0; s < sharded.shards(); ++s) {
+            ran += sharded.check(s, now);
+        }
+        for (auto &task : tasks) {
+            if (now.unix_time() % task->interval() == 0) {
+                expected++;
+            }
+        }
+        ASSERT_GT(sharded.nextTime(), now.unix_time());
+        now += 1;
+    }
+
+    auto runs = 0u;
+    for (auto &task : tasks) {
+        runs += task->runs();
+    }
+    ASSERT_EQ(runs, expected);
+    ASSERT_EQ(sharded.stats().runs, expected);
+}
+
+TEST_F(ShardedSchedulerSuite, NextTimeIsTheEarliestShard) {
+    RecordingTask hourly{ 3600 };
+    RecordingTask minutely{ 60 };
+    ShardedScheduler sharded{ 8 };
+    sharded.add(&hourly, JacobsBirth);
+    sharded.add(&minutely, JacobsBirth);
+
+    ASSERT_EQ(sharded.nextTime(), UINT32_MAX);
+
+    auto now = JacobsBirth + 1;
+    sharded.begin(now);
+    ASSERT_EQ(sharded.nextTime(), JacobsBirth.unix_time() + 60);
+
+    auto together = sharded.shard(&hourly) == sharded.shard(&minutely);
+    ASSERT_EQ(sharded.nextTime(sharded.shard(&hourly)), JacobsBirth.unix_time() + (together ? 60 : 1800));
+}
+
+TEST_F(ShardedSchedulerSuite, AddAfterCheckingRunsEachTaskOnce) {
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (auto i = 0u; i < 12; ++i) {
+        tasks.emplace_back(new RecordingTask(1800));
+    }
+
+    ShardedScheduler sharded{ 4 };
+    auto now = JacobsBirth;
+    for (auto i = 0u; i < 6; ++i) {
+        sharded.add(tasks[i].get(), now);
+    }
+
+    sharded.begin(now);
+    for (auto s = (size_t)0; s < sharded.shards(); ++s) {
+        sharded.check(s, now);
+    }
+
+    // Due at now too, so they run late in the next check. The ones that
+    // ran at now aren't due again for half an hour.
+    for (auto i = 6u; i < 12; ++i) {
+        sharded.add(tasks[i].get(), now);
+    }
+    for (auto i = 1; i <= 10; ++i) {
+        for (auto s = (size_t)0; s < sharded.shards(); ++s) {
+            sharded.check(s, now + i);
+        }
+    }
+
+    for (auto &task : tasks) {
+        ASSERT_EQ(task->runs(), 1u);
+    }
+    ASSERT_EQ(sharded.stats().runs, 12u);
+}
+
+TEST_F(ShardedSchedulerSuite, AddToAnIdleShardSchedulesFromNow) {
+    RecordingTask every30m{ 1800 };
+    ShardedScheduler sharded{ 2 };
+
+    // Begun, but not checked since, so the shard's idea of now is stale.
+    sharded.begin(JacobsBirth + 1);
+    auto now = JacobsBirth + 2000;
+    sharded.add(&every30m, now);
+
+    auto shard = sharded.shard(&every30m);
+    ASSERT_EQ(sharded.nextTime(shard), JacobsBirth.unix_time() + 3600);
+    ASSERT_EQ(sharded.check(shard, now + 1), 0u);
+    ASSERT_EQ(sharded.check(shard, JacobsBirth + 3600), 1u);
+    ASSERT_EQ(every30m.runs(), 1u);
+}
+
+TEST_F(ShardedSchedulerSuite, GrowingKeepsSchedules) {
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (auto i = 0u; i < 40; ++i) {
+        tasks.emplace_back(new RecordingTask(1000));
+    }
+
+    // One shard, so adding after the check grows it, twice.
+    ShardedScheduler sharded{ 1 };
+    auto now = JacobsBirth;
+    for (auto i = 0u; i < 16; ++i) {
+        sharded.add(tasks[i].get(), now);
+    }
+
+    sharded.begin(now);
+    ASSERT_EQ(sharded.check(0, now), 16u);
+
+    for (auto i = 16u; i < 40; ++i) {
+        sharded.add(tasks[i].get(), now);
+    }
+    ASSERT_EQ(sharded.nextTime(), now.unix_time());
+    ASSERT_EQ(sharded.check(0, now + 1), 24u);
+    ASSERT_EQ(sharded.check(0, now + 2), 0u);
+    ASSERT_EQ(sharded.nextTime(), now.unix_time() + 1000);
+
+    for (auto &task : tasks) {
+        ASSERT_EQ(task->runs(), 1u);
+    }
+}
+
+TEST_F(ShardedSchedulerSuite, AddWhileChecking) {
+    std::vector<std::unique_ptr<RecordingTask>> tasks;
+    for (auto i = 0u; i < 400; ++i) {
+        tasks.emplace_back(new RecordingTask(1));
+    }
+
+    ShardedScheduler sharded{ 4 };
+    sharded.begin(JacobsBirth);
+
+    std::atomic<bool> adding{ true };
+    std::vector<std::thread> threads;
+    for (auto s = (size_t)0; s < sharded.shards(); ++s) {
+        threads.emplace_back([&, s]() {
+            auto now = JacobsBirth;
+            while (adding) {
+                sharded.check(s, now);
+                now += 1;
+            }
+            sharded.check(s, now);
+        });
+    }
+
+    for (auto &task : tasks) {
+        sharded.add(task.get(), JacobsBirth);
+    }
+    adding = false;
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(sharded.stats().tasks, 400u);
+    for (auto &task : tasks) {
+        ASSERT_GE(task->runs(), 1u);
+    }
+}
+
+#endif
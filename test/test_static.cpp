@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/static.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class StaticSchedulerSuite : public ::testing::Test {
+protected:
+
+};
+
+struct CountingPeriodicTask : StaticPeriodicTask {
+    std::vector<uint32_t> *ran;
+    uint32_t id;
+
+    CountingPeriodicTask(uint32_t interval, std::vector<uint32_t> *ran, uint32_t id) : StaticPeriodicTask(interval), ran(ran), id(id) {
+    }
+
+    void run() {
+        ran->push_back(id);
+    }
+};
+
+struct CountingCronTask : StaticCronTask {
+    std::vector<uint32_t> *ran;
+    uint32_t id;
+    bool on{ true };
+
+    CountingCronTask(CronSpec spec, uint32_t jitter, std::vector<uint32_t> *ran, uint32_t id) : StaticCronTask(spec, jitter), ran(ran), id(id) {
+    }
+
+    bool enabled() const {
+        return on;
+    }
+
+    void run() {
+        ran->push_back(id);
+    }
+};
+
+TEST_F(StaticSchedulerSuite, RunsSameTasksAsScheduler) {
+    PeriodicTask every10{ 10 };
+    PeriodicTask every97{ 97 };
+    CronTask fives{ CronSpec::everyFiveMinutes() };
+    CronTask quarter{ CronSpec::specific(0, 15), 20 };
+    CronTask invalid;
+    Task *tasks[] = { &every10, &every97, &fives, &quarter, &invalid };
+    Scheduler scheduler{ tasks };
+
+    std::vector<uint32_t> ran;
+    StaticScheduler<CountingPeriodicTask, CountingPeriodicTask, CountingCronTask, CountingCronTask, CountingCronTask> fixed{
+        { 10, &ran, 0 },
+        { 97, &ran, 1 },
+        { CronSpec::everyFiveMinutes(), 0, &ran, 2 },
+        { CronSpec::specific(0, 15), 20, &ran, 3 },
+        { CronSpec{ }, 0, &ran, 4 },
+    };
+    ASSERT_EQ(fixed.size(), 5u);
+
+    scheduler.begin(JacobsBirth);
+    fixed.begin(JacobsBirth);
+
+    auto seed = 1u;
+    for (auto now = JacobsBirth; now.unix_time() < JacobsBirth.unix_time() + 60 * 60 * 3; now += 1) {
+        std::vector<uint32_t> expected;
+        Scheduler::TaskAndTime due[5];
+        auto n = scheduler.check(now, due, seed);
+        for (auto i = (size_t)0; i < n; ++i) {
+            expected.push_back(std::find(tasks, tasks + 5, due[i].task) - tasks);
+        }
+
+        ran.clear();
+        ASSERT_EQ(fixed.check(now, seed), n);
+        ASSERT_EQ(ran, expected);
+        ASSERT_EQ(fixed.nextTime(), scheduler.nextTask().time);
+
+        seed = seed * 1103515245 + 12345;
+    }
+}
+
+TEST_F(StaticSchedulerSuite, DisabledTasksAreSkipped) {
+    std::vector<uint32_t> ran;
+    StaticScheduler<CountingCronTask, StaticPeriodicTask> fixed{
+        { CronSpec::interval(10), 0, &ran, 0 },
+        { 60 },
+    };
+
+    fixed.begin(JacobsBirth);
+    ASSERT_EQ(fixed.check(JacobsBirth), 2u);
+    ASSERT_EQ(fixed.secondsUntilNextTask(JacobsBirth + 1), 9u);
+
+    fixed.get<0>().on = false;
+    ASSERT_EQ(fixed.check(JacobsBirth + 10), 0u);
+    ASSERT_EQ(fixed.nextTime(), JacobsBirth.unix_time() + 60);
+    ASSERT_EQ(fixed.get<1>().interval(), 60u);
+    ASSERT_EQ(ran.size(), 1u);
+
+    StaticScheduler<> empty;
+    ASSERT_EQ(empty.check(JacobsBirth), 0u);
+    ASSERT_EQ(empty.secondsUntilNextTask(JacobsBirth), UINT32_MAX);
+}
+
+TEST_F(StaticSchedulerSuite, ClockMovingBackwards) {
+    StaticScheduler<StaticPeriodicTask> fixed{ { 150 } };
+
+    auto now = JacobsBirth - 1;
+    fixed.begin(now);
+    ASSERT_EQ(fixed.check(now), 0u);
+
+    now += 1;
+    ASSERT_EQ(fixed.check(now), 1u);
+    ASSERT_EQ(fixed.nextTime(), now.unix_time() + 150);
+
+    // A few seconds back is ignored.
+    ASSERT_EQ(fixed.check(now - 10), 0u);
+    ASSERT_EQ(fixed.nextTime(), now.unix_time() + 150);
+
+    // Further begins again.
+    now -= 60 * 60 * 2 + 1;
+    ASSERT_EQ(fixed.check(now), 0u);
+    ASSERT_EQ(fixed.nextTime(), now.unix_time() + 1);
+    ASSERT_EQ(fixed.check(now + 1), 1u);
+}
@@ -0,0 +1,133 @@
+#if !defined(ARDUINO)
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/submissions.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class SubmissionsSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(SubmissionsSuite, AppliedAtTheStartOfCheck) {
+    CronTask every5{ CronSpec::interval(5) };
+    CronTask every6{ CronSpec::interval(6) };
+    Task *tasks[2];
+    HeapQueue::Slot slots[2];
+    HeapQueue queue{ slots };
+    Scheduler scheduler{ tasks, 0, 2, queue };
+    Submissions<4> submissions;
+    scheduler.changes(submissions);
+
+    // Between the two tasks' times.
+    auto now = JacobsBirth + 1;
+    scheduler.begin(now);
+
+    ASSERT_TRUE(submissions.add(&every5));
+    ASSERT_TRUE(submissions.add(&every6));
+    // The scheduler's full, so this fails when applied.
+    ASSERT_TRUE(submissions.add(&every6));
+    ASSERT_TRUE(submissions.remove(&every5));
+    ASSERT_FALSE(submissions.remove(&every6));
+    ASSERT_EQ(scheduler.size(), 0u);
+
+    ASSERT_FALSE(scheduler.check(now));
+    ASSERT_EQ(scheduler.size(), 1u);
+    ASSERT_EQ(scheduler[0], &every6);
+    ASSERT_EQ(submissions.applied(), 3u);
+    ASSERT_EQ(submissions.failed(), 1u);
+
+    // And there's room again.
+    ASSERT_TRUE(submissions.remove(&every6));
+    ASSERT_FALSE(scheduler.check(now));
+    ASSERT_EQ(scheduler.size(), 0u);
+}
+
+// Producers keep adding and removing their own tasks while another thread
+// checks, worth running with -fsanitize=thread.
+TEST_F(SubmissionsSuite, ManyProducers) {
+    constexpr size_t Producers = 4;
+    constexpr size_t TasksEach = 32;
+    constexpr size_t Rounds = 50;
+
+    std::vector<CronTask> all;
+    all.reserve(Producers * TasksEach);
+    for (auto i = 0u; i < Producers * TasksEach; ++i) {
+        all.emplace_back(CronSpec::interval(1 + i % 13));
+    }
+
+    std::vector<Task*> tasks(all.size());
+    std::vector<HeapQueue::Slot> slots(all.size());
+    HeapQueue queue{ slots.data(), slots.size() };
+    Scheduler scheduler{ tasks.data(), 0, tasks.size(), queue };
+    Submissions<64> submissions;
+    scheduler.changes(submissions);
+    scheduler.begin(JacobsBirth);
+
+    std::atomic<size_t> producing{ Producers };
+    std::atomic<uint32_t> fired{ 0 };
+
+    std::thread dispatcher{ [&]() {
+        auto now = JacobsBirth;
+        while (producing > 0) {
+            while (scheduler.check(now)) {
+                fired++;
+            }
+            now += 1;
+        }
+        scheduler.check(now);
+    } };
+
+    std::vector<std::thread> producers;
+    for (auto p = (size_t)0; p < Producers; ++p) {
+        producers.emplace_back([&, p]() {
+            auto mine = &all[p * TasksEach];
+            auto submit = [&](Submissions<64>::Operation operation, Task *task) {
+                while (!submissions.submit(operation, task)) {
+                    std::this_thread::yield();
+                }
+            };
+            for (auto round = (size_t)0; round < Rounds; ++round) {
+                for (auto i = (size_t)0; i < TasksEach; ++i) {
+                    submit(Submissions<64>::Operation::Add, &mine[i]);
+                }
+                for (auto i = (size_t)0; i < TasksEach; ++i) {
+                    submit(Submissions<64>::Operation::Refresh, &mine[i]);
+                }
+                if (round + 1 < Rounds) {
+                    for (auto i = (size_t)0; i < TasksEach; ++i) {
+                        submit(Submissions<64>::Operation::Remove, &mine[i]);
+                    }
+                }
+            }
+            producing--;
+        });
+    }
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    dispatcher.join();
+
+    ASSERT_EQ(submissions.failed(), 0u);
+    ASSERT_EQ(submissions.applied(), Producers * TasksEach * (Rounds * 3 - 1));
+    ASSERT_EQ(scheduler.size(), all.size());
+
+    std::set<Task*> scheduled;
+    for (auto i = (size_t)0; i < scheduler.size(); ++i) {
+        scheduled.insert(scheduler[i]);
+    }
+    ASSERT_EQ(scheduled.size(), all.size());
+    ASSERT_GT(fired.load(), 0u);
+}
+
+#endif
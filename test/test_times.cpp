@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/times.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class FireTimesSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(FireTimesSuite, CronSpecTimesMatchGetNextTime) {
+    CronSpec specs[] = {
+        CronSpec::everyFiveMinutes(),
+        CronSpec::specific(0, 15, 6),
+        CronSpec::specific(30),
+        CronSpec::interval(7),
+        CronSpec::interval(7200),
+        CronSpec::bits(1ull << 10 | 1ull << 50, 1ull << 0 | 1ull << 59, 1u << 0 | 1u << 12 | 1u << 23),
+    };
+
+    auto to = JacobsBirth + 86400 * 3;
+    for (auto &spec : specs) {
+        std::vector<uint32_t> expected;
+        for (auto time = spec.getNextTime(JacobsBirth); time < to.unix_time(); time = spec.getNextTime(time + 1)) {
+            expected.push_back(time);
+        }
+
+        std::vector<uint32_t> times;
+        for (auto time : FireTimes{ spec, JacobsBirth, to }) {
+            times.push_back(time);
+        }
+        ASSERT_EQ(times, expected);
+        ASSERT_GT(times.size(), 0u);
+    }
+
+    // Invalid specs never fire.
+    for (auto time : FireTimes{ CronSpec{ }, JacobsBirth, to }) {
+        FAIL() << time;
+    }
+}
+
+TEST_F(FireTimesSuite, TaskTimesInBulk) {
+    PeriodicTask periodic{ 97 };
+    CronTask cron{ CronSpec::everyTwentyMinutes(), 30 };
+    Task *tasks[] = { &periodic, &cron };
+
+    auto to = JacobsBirth + 86400;
+    for (auto task : tasks) {
+        std::vector<uint32_t> expected;
+        for (auto time = task->getNextTime(JacobsBirth, 17); time < to.unix_time(); time = task->getNextTime(time + 1, 17)) {
+            expected.push_back(time);
+        }
+
+        std::vector<uint32_t> times;
+        FireTimes fire_times{ *task, JacobsBirth, to, 17 };
+        uint32_t buffer[7];
+        while (auto n = fire_times.fill(buffer)) {
+            times.insert(times.end(), buffer, buffer + n);
+        }
+        ASSERT_EQ(times, expected);
+    }
+}
+
+TEST_F(FireTimesSuite, SchedulerTimesMatchChecking) {
+    PeriodicTask every10{ 10 };
+    PeriodicTask every97{ 97 };
+    CronTask fives{ CronSpec::everyFiveMinutes() };
+    CronTask quarter{ CronSpec::specific(0, 15) };
+    CronTask invalid;
+    Task *tasks[] = { &every10, &every97, &fives, &quarter, &invalid };
+    Scheduler scheduler{ tasks };
+
+    auto to = JacobsBirth + 60 * 60 * 3;
+
+    std::vector<std::pair<uint32_t, Task*>> expected;
+    scheduler.begin(JacobsBirth);
+    for (auto now = JacobsBirth; now.unix_time() < to.unix_time(); now += 1) {
+        while (auto tt = scheduler.check(now)) {
+            expected.emplace_back(tt.time, tt.task);
+        }
+    }
+
+    HeapQueue::Slot slots[5];
+    HeapQueue queue{ slots };
+    std::vector<std::pair<uint32_t, Task*>> times;
+    for (auto tt : SchedulerTimes{ scheduler, queue, JacobsBirth, to }) {
+        times.emplace_back(tt.time, tt.task);
+    }
+
+    ASSERT_EQ(times, expected);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/trace.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class TraceSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(TraceSuite, NewestEventsOverwriteOldest) {
+    TraceEvent storage[6];
+    TraceBuffer buffer{ storage };
+    ASSERT_EQ(buffer.capacity(), 4u);
+
+    for (auto i = 0u; i < 10; ++i) {
+        buffer.record(TraceType::Check, i, 100 + i, TraceEvent::NoTask);
+    }
+    ASSERT_EQ(buffer.recorded(), 10u);
+
+    // The oldest is the next to be written over, so isn't read.
+    uint32_t cursor = 0;
+    TraceEvent events[2];
+    ASSERT_EQ(buffer.read(cursor, events), 2u);
+    ASSERT_EQ(events[0].micros, 7u);
+    ASSERT_EQ(events[1].time, 108u);
+    ASSERT_EQ(cursor, 9u);
+
+    ASSERT_EQ(buffer.read(cursor, events), 1u);
+    ASSERT_EQ(events[0].micros, 9u);
+    ASSERT_EQ(buffer.read(cursor, events), 0u);
+
+    buffer.record(TraceType::Due, 10, 110, 70000);
+    ASSERT_EQ(buffer.read(cursor, events), 1u);
+    ASSERT_EQ(events[0].type, TraceType::Due);
+    ASSERT_EQ(events[0].task, 70000u);
+    ASSERT_EQ(cursor, 11u);
+}
+
+TEST_F(TraceSuite, ReadWhileRecording) {
+    // Small, so the recorder laps the reader all the time.
+    TraceEvent storage[16];
+    TraceBuffer buffer{ storage };
+
+    // Every field follows from micros, so a torn event shows.
+    const auto number = 1000000u;
+    std::thread recorder{ [&]() {
+        for (auto i = 1u; i <= number; ++i) {
+            buffer.record(i % 2 == 0 ? TraceType::Due : TraceType::Check, i, ~i, i & 0xfff);
+        }
+    } };
+
+    uint32_t cursor = 0;
+    auto last = 0u;
+    auto read = 0u;
+    while (last < number) {
+        TraceEvent events[8];
+        auto n = buffer.read(cursor, events);
+        for (auto i = (size_t)0; i < n; ++i) {
+            auto &event = events[i];
+            ASSERT_GT(event.micros, last);
+            ASSERT_EQ(event.time, ~event.micros);
+            ASSERT_EQ(event.task, event.micros & 0xfff);
+            ASSERT_EQ(event.type, event.micros % 2 == 0 ? TraceType::Due : TraceType::Check);
+            last = event.micros;
+            read++;
+        }
+    }
+
+    recorder.join();
+    ASSERT_EQ(buffer.recorded(), number);
+    ASSERT_GT(read, 0u);
+}
+
+TEST_F(TraceSuite, SchedulerRecordsChecksDueTasksAndRuns) {
+    PeriodicTask every10{ 10 };
+    PeriodicTask every15{ 15 };
+    Task *tasks[] = { &every10, &every15 };
+    Scheduler scheduler{ tasks };
+
+    TraceEvent storage[64];
+    TraceBuffer buffer{ storage };
+    scheduler.trace(buffer);
+
+    auto now = JacobsBirth;
+    scheduler.begin(now);
+    Scheduler::TaskAndTime due[2];
+    scheduler.check(now, due);
+    scheduler.check(now + 1, due);
+    // Late, and then the clock going back.
+    scheduler.check(now + 12, due);
+    scheduler.check(now - 3600, due);
+
+    uint32_t cursor = 0;
+    TraceEvent events[64];
+    auto n = buffer.read(cursor, events);
+
+    std::vector<std::tuple<TraceType, uint32_t, uint32_t>> expected = {
+        std::make_tuple(TraceType::Check, now.unix_time(), TraceEvent::NoTask),
+        std::make_tuple(TraceType::Due, now.unix_time(), 0),
+        std::make_tuple(TraceType::RunBegin, now.unix_time(), 0),
+        std::make_tuple(TraceType::RunEnd, now.unix_time(), 0),
+        std::make_tuple(TraceType::Due, now.unix_time(), 1),
+        std::make_tuple(TraceType::RunBegin, now.unix_time(), 1),
+        std::make_tuple(TraceType::RunEnd, now.unix_time(), 1),
+        std::make_tuple(TraceType::Check, now.unix_time() + 1, TraceEvent::NoTask),
+        std::make_tuple(TraceType::Check, now.unix_time() + 12, TraceEvent::NoTask),
+        std::make_tuple(TraceType::Due, now.unix_time() + 10, 0),
+        std::make_tuple(TraceType::RunBegin, now.unix_time() + 12, 0),
+        std::make_tuple(TraceType::RunEnd, now.unix_time() + 12, 0),
+        std::make_tuple(TraceType::Check, now.unix_time() - 3600, TraceEvent::NoTask),
+        std::make_tuple(TraceType::Rebegin, now.unix_time() + 12, TraceEvent::NoTask),
+    };
+
+    std::vector<std::tuple<TraceType, uint32_t, uint32_t>> recorded;
+    for (auto i = (size_t)0; i < n; ++i) {
+        recorded.emplace_back(events[i].type, events[i].time, events[i].task);
+    }
+    ASSERT_EQ(recorded, expected);
+
+    // Due tasks share their check's clock and runs come after it.
+    ASSERT_EQ(events[1].micros, events[0].micros);
+    ASSERT_GE(events[2].micros, events[0].micros);
+    ASSERT_GE(events[3].micros, events[2].micros);
+}
+
+TEST_F(TraceSuite, ChromeTraceJson) {
+    auto now = JacobsBirth.unix_time();
+    TraceEvent events[] = {
+        { 1000, now, TraceEvent::NoTask, TraceType::Check, 0 },
+        { 1000, now - 2, 0, TraceType::Due, 0 },
+        { 1010, now, 0, TraceType::RunBegin, 0 },
+        { 1500, now, 0, TraceType::RunEnd, 0 },
+        { 2000, now, 1, TraceType::RunBegin, 0 },
+        { 2100, now, 1, TraceType::RunEnd, 0 },
+        // Past what 16 bits would hold, and what would have been NoTask.
+        { 2200, now, 70000, TraceType::RunBegin, 0 },
+        { 2300, now, 65535, TraceType::RunBegin, 0 },
+        // The clock wrapping.
+        { 50, now - 7200, TraceEvent::NoTask, TraceType::Check, 0 },
+        { 50, now, TraceEvent::NoTask, TraceType::Rebegin, 0 },
+    };
+    const char *names[] = { "read \"sensors\"" };
+
+    auto file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    ASSERT_TRUE(trace_to_chrome_json(file, events, sizeof(events) / sizeof(events[0]), names, 1));
+
+    std::string json(ftell(file), '\0');
+    rewind(file);
+    ASSERT_EQ(fread(&json[0], 1, json.size(), file), json.size());
+    fclose(file);
+
+    auto contains = [&](std::string const &part) {
+        return json.find(part) != std::string::npos;
+    };
+
+    ASSERT_EQ(json.find("{\"traceEvents\":["), 0u);
+    ASSERT_TRUE(contains("\"args\":{\"name\":\"read \\\"sensors\\\"\"}"));
+    ASSERT_TRUE(contains("\"args\":{\"name\":\"task 1\"}"));
+    ASSERT_TRUE(contains("{\"name\":\"check\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":0,\"ts\":1000,"));
+    // Two seconds late, clamped at the start of the trace.
+    ASSERT_TRUE(contains("{\"name\":\"due\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":0,\"dur\":1000,"));
+    ASSERT_TRUE(contains("\"ph\":\"B\",\"pid\":1,\"tid\":1,\"ts\":1010}"));
+    ASSERT_TRUE(contains("{\"name\":\"task 1\",\"ph\":\"E\",\"pid\":1,\"tid\":2,\"ts\":2100}"));
+    ASSERT_TRUE(contains("{\"name\":\"task 70000\",\"ph\":\"B\",\"pid\":1,\"tid\":70001,\"ts\":2200}"));
+    ASSERT_TRUE(contains("{\"name\":\"task 65535\",\"ph\":\"B\",\"pid\":1,\"tid\":65536,\"ts\":2300}"));
+    ASSERT_TRUE(contains("\"ts\":4294967346,\"args\":{\"from\":" + std::to_string(now) + ",\"to\":" + std::to_string(now - 7200) + "}"));
+    ASSERT_TRUE(contains("],\"displayTimeUnit\":\"ms\"}"));
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <lwcron/lwcron.h>
+#include <lwcron/wheel.h>
+
+using namespace lwcron;
+
+static DateTime JacobsBirth{ 1982, 4, 23, 7, 30, 00 };
+
+class TimingWheelSuite : public ::testing::Test {
+protected:
+
+};
+
+TEST_F(TimingWheelSuite, PopsInTimeOrder) {
+    TimingWheel::Slot slots[6];
+    TimingWheel wheel{ slots };
+
+    auto now = JacobsBirth.unix_time();
+    wheel.clear(now);
+
+    uint32_t times[] = { now + 86400 * 100, now + 3, now + 70, now + 3600 * 5, now + 86400 * 3, now };
+    for (auto i = 0u; i < 6; ++i) {
+        ASSERT_TRUE(wheel.push(i, times[i]));
+    }
+    ASSERT_EQ(wheel.size(), 6u);
+
+    uint32_t index;
+    uint32_t time;
+    uint32_t expected[] = { 5, 1, 2, 3, 4, 0 };
+    for (auto i : expected) {
+        ASSERT_TRUE(wheel.peek(index, time));
+        ASSERT_EQ(index, i);
+        ASSERT_EQ(time, times[i]);
+
+        ASSERT_FALSE(wheel.pop(times[i] - 1, index));
+        ASSERT_TRUE(wheel.pop(times[i], index));
+        ASSERT_EQ(index, i);
+    }
+
+    ASSERT_EQ(wheel.size(), 0u);
+    ASSERT_FALSE(wheel.peek(index, time));
+}
+
+TEST_F(TimingWheelSuite, ClockMovingBackwardsAFewSeconds) {
+    TimingWheel::Slot slots[1];
+    TimingWheel wheel{ slots };
+
+    auto now = JacobsBirth.unix_time();
+    wheel.clear(now);
+    wheel.push(0, now + 5);
+
+    uint32_t index;
+    ASSERT_FALSE(wheel.pop(now + 4, index));
+    ASSERT_FALSE(wheel.pop(now + 2, index));
+
+    wheel.push(0, now + 3);
+    ASSERT_FALSE(wheel.pop(now + 2, index));
+    ASSERT_TRUE(wheel.pop(now + 3, index));
+}
+
+TEST_F(TimingWheelSuite, SchedulerRunsTheSameTasksAsHeap) {
+    std::vector<PeriodicTask> periodic;
+    std::vector<CronTask> cron;
+    for (auto i = 0u; i < 50; ++i) {
+        periodic.emplace_back(5 + i * 37);
+    }
+    periodic.emplace_back(86400 * 80);
+    cron.emplace_back(CronSpec::specific(15, 45));
+    cron.emplace_back(CronSpec::specific(0, 0, 3));
+    cron.emplace_back(CronSpec::everyFiveMinutes());
+
+    std::vector<Task*> tasks;
+    for (auto &task : periodic) {
+        tasks.push_back(&task);
+    }
+    for (auto &task : cron) {
+        tasks.push_back(&task);
+    }
+
+    std::vector<HeapQueue::Slot> heap_slots(tasks.size());
+    HeapQueue heap{ heap_slots.data(), heap_slots.size() };
+    std::vector<TimingWheel::Slot> wheel_slots(tasks.size());
+    TimingWheel wheel{ wheel_slots.data(), wheel_slots.size() };
+
+    Scheduler heaped{ tasks.data(), tasks.size(), heap };
+    Scheduler wheeled{ tasks.data(), tasks.size(), wheel };
+
+    // Check every second for a while, then jump ahead in larger steps.
+    std::vector<uint32_t> steps;
+    for (auto i = 0; i < 60 * 60 * 2; ++i) {
+        steps.push_back(1);
+    }
+    for (auto i = 0; i < 400; ++i) {
+        steps.push_back(61 * 60 + i);
+    }
+    for (auto i = 0; i < 100; ++i) {
+        steps.push_back(86400 + 7);
+    }
+
+    auto simulate = [&](Scheduler &scheduler) {
+        std::vector<std::pair<uint32_t, Task*>> fired;
+        auto now = JacobsBirth;
+        scheduler.begin(now);
+        for (auto step : steps) {
+            auto first = fired.size();
+            while (auto tt = scheduler.check(now)) {
+                fired.emplace_back(tt.time, tt.task);
+            }
+            std::sort(fired.begin() + first, fired.end());
+            now += step;
+        }
+        return fired;
+    };
+
+    auto expected = simulate(heaped);
+    ASSERT_EQ(simulate(wheeled), expected);
+    ASSERT_GT(expected.size(), 1000u);
+}
+
+TEST_F(TimingWheelSuite, TasksAddedBeforeBegin) {
+    std::vector<PeriodicTask> periodic;
+    for (auto i = 0u; i < 2000; ++i) {
+        periodic.emplace_back(60 + i * 7);
+    }
+
+    std::vector<HeapQueue::Slot> heap_slots(periodic.size());
+    HeapQueue heap{ heap_slots.data(), heap_slots.size() };
+    std::vector<TimingWheel::Slot> wheel_slots(periodic.size());
+    TimingWheel wheel{ wheel_slots.data(), wheel_slots.size() };
+
+    std::vector<Task*> heap_tasks(periodic.size());
+    std::vector<Task*> wheel_tasks(periodic.size());
+    Scheduler heaped{ heap_tasks.data(), 0, heap_tasks.size(), heap };
+    Scheduler wheeled{ wheel_tasks.data(), 0, wheel_tasks.size(), wheel };
+
+    // The wheel has never been cleared to now, its cursor's still at the
+    // epoch and everything's decades away.
+    auto simulate = [&](Scheduler &scheduler) {
+        std::vector<std::pair<uint32_t, Task*>> fired;
+        auto now = JacobsBirth;
+        for (auto &task : periodic) {
+            scheduler.add(&task, now);
+        }
+        for (auto i = 0; i < 60 * 10; ++i) {
+            auto first = fired.size();
+            while (auto tt = scheduler.check(now)) {
+                fired.emplace_back(tt.time, tt.task);
+            }
+            std::sort(fired.begin() + first, fired.end());
+            now += 1;
+        }
+        return fired;
+    };
+
+    auto expected = simulate(heaped);
+    ASSERT_EQ(simulate(wheeled), expected);
+    ASSERT_GT(expected.size(), 100u);
+}
+
+TEST_F(TimingWheelSuite, RemoveAndMove) {
+    TimingWheel::Slot slots[8];
+    TimingWheel wheel{ slots };
+
+    auto now = JacobsBirth.unix_time();
+    wheel.clear(now);
+
+    uint32_t times[] = { now + 86400 * 100, now + 3, now + 70, now + 3600 * 5, now + 86400 * 3, now + 3 };
+    for (auto i = 0u; i < 6; ++i) {
+        ASSERT_TRUE(wheel.push(i, times[i]));
+    }
+
+    ASSERT_TRUE(wheel.remove(3));
+    ASSERT_FALSE(wheel.remove(3));
+    ASSERT_TRUE(wheel.move(5, 7));
+    ASSERT_FALSE(wheel.move(5, 6));
+    ASSERT_TRUE(wheel.move(0, 6));
+    // Pushing something already queued moves it.
+    ASSERT_TRUE(wheel.push(2, now + 2));
+    ASSERT_EQ(wheel.size(), 5u);
+
+    uint32_t index;
+    uint32_t time;
+    uint32_t expected[] = { 2, 1, 7, 4, 6 };
+    uint32_t expected_times[] = { now + 2, now + 3, now + 3, now + 86400 * 3, now + 86400 * 100 };
+    for (auto i = 0u; i < 5; ++i) {
+        ASSERT_TRUE(wheel.peek(index, time));
+        ASSERT_EQ(index, expected[i]);
+        ASSERT_EQ(time, expected_times[i]);
+        ASSERT_TRUE(wheel.pop(time, index));
+        ASSERT_EQ(index, expected[i]);
+    }
+    ASSERT_FALSE(wheel.peek(index, time));
+    ASSERT_EQ(wheel.size(), 0u);
+}
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <lwcron/trace.h>
+
+using namespace lwcron;
+
+// lwcron-trace2json events.bin [names.txt] > trace.json
+//
+// events.bin is TraceEvents as they are in memory, copied out with
+// TraceBuffer::read or dumped from a device's RAM, in the order they were
+// recorded. names.txt has a task name per line, in the scheduler's order.
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s events.bin [names.txt] > trace.json\n", argv[0]);
+        return 2;
+    }
+
+    auto file = fopen(argv[1], "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "%s: unable to open %s\n", argv[0], argv[1]);
+        return 1;
+    }
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    while (fread(&event, sizeof(event), 1, file) == 1) {
+        events.push_back(event);
+    }
+    fclose(file);
+
+    std::vector<std::string> lines;
+    if (argc == 3) {
+        auto names = fopen(argv[2], "r");
+        if (names == nullptr) {
+            fprintf(stderr, "%s: unable to open %s\n", argv[0], argv[2]);
+            return 1;
+        }
+        char line[256];
+        while (fgets(line, sizeof(line), names) != nullptr) {
+            line[strcspn(line, "\r\n")] = 0;
+            lines.push_back(line);
+        }
+        fclose(names);
+    }
+
+    std::vector<const char*> names;
+    for (auto &line : lines) {
+        names.push_back(line.c_str());
+    }
+
+    if (!trace_to_chrome_json(stdout, events.data(), events.size(), names.data(), names.size())) {
+        fprintf(stderr, "%s: error writing trace\n", argv[0]);
+        return 1;
+    }
+
+    return 0;
+}